@@ -30,6 +30,8 @@ SRL::AccelGyro::AccelGyro(float aC, float gC)
 	angleX = Angle();
 	angleY = Angle();
 	angleZ = Angle();
+	prevGyro = Axes();
+	lastUpdate = 0;
 }
 
 /**
@@ -39,11 +41,16 @@ SRL::AccelGyro::AccelGyro(float aC, float gC)
 */
 void SRL::AccelGyro::update(unsigned int sampleSize)
 {
-	static unsigned long t1 = 0;
-	unsigned long t2 = micros();
+	Sample<Axes> gyro = sampleGyro(sampleSize);
+	Sample<Axes> accel = sampleAccel(sampleSize);
 
-	update(t2 - t1, sampleSize);
-	t1 = t2;
+	// Integrate over the time between the gyro samples, not between calls
+	if (lastUpdate != 0)
+	{
+		fuse(gyro.value, accel.value, gyro.timestamp - lastUpdate);
+	}
+
+	lastUpdate = gyro.timestamp;
 }
 
 /**
@@ -54,20 +61,36 @@ void SRL::AccelGyro::update(unsigned int sampleSize)
 */
 void SRL::AccelGyro::update(unsigned long deltaT, unsigned int sampleSize)
 {
-	static double prevGyroX = 0.0;
-	static double prevGyroY = 0.0;
-	static double prevGyroZ = 0.0;
-	double gyroX = getGyroXMedian(sampleSize);
-	double gyroY = getGyroYMedian(sampleSize);
-	double gyroZ = getGyroZMedian(sampleSize);
+	Sample<Axes> gyro = sampleGyro(sampleSize);
+	Sample<Axes> accel = sampleAccel(sampleSize);
+
+	fuse(gyro.value, accel.value, deltaT);
+	lastUpdate = gyro.timestamp;
+}
 
-	angleX.add((((prevGyroX + gyroX) / 2) * (deltaT / 1000000) * gC) + (aC * ((atan2f(getAccelYMedian(sampleSize), getAccelZMedian(sampleSize) + abs(getAccelXMedian(sampleSize))) * 180 ) / PI)));
+/**
+*	Combine gyroscope and accelerometer readings into the angles.
+*
+*	@param gyro The gyroscope's readings.
+*	@param accel The accelerometer's readings.
+*	@param deltaT The time between this and the previous gyroscope readings. Time in micro seconds.
+*/
+void SRL::AccelGyro::fuse(Axes gyro, Axes accel, unsigned long deltaT)
+{
+	angleX.add((((prevGyro.x + gyro.x) / 2) * (deltaT / 1000000.0) * gC) + (aC * ((atan2f(accel.y, accel.z + abs(accel.x)) * 180 ) / PI)));
 	//angleY.add();
 	//angleZ.add();
 
-	prevGyroX = gyroX;
-	prevGyroY = gyroY;
-	prevGyroZ = gyroZ;
+	prevGyro = gyro;
+}
+
+/**
+*	Returns the capture time of the gyroscope readings last used by update().
+*
+*/
+unsigned long SRL::AccelGyro::getLastUpdate(void)
+{
+	return lastUpdate;
 }
 
 float SRL::AccelGyro::getAccelCoeff(void)
@@ -119,3 +142,42 @@ void SRL::AccelGyro::setAngleZ(float angle)
 {
 	angleZ.setAngle(angle);
 }
+
+/**
+*	Returns the size of the accelerometer's and gyroscope's calibration data.
+*
+*/
+uint8_t SRL::AccelGyro::getCalibrationSize(void)
+{
+	return Accelerometer::getCalibrationSize() + Gyroscope::getCalibrationSize();
+}
+
+/**
+*	Writes the accelerometer's, then the gyroscope's calibration data to a buffer.
+*
+*	@param data The buffer of getCalibrationSize() bytes.
+*/
+void SRL::AccelGyro::saveCalibration(byte* data)
+{
+	Accelerometer::saveCalibration(data);
+	Gyroscope::saveCalibration(data + Accelerometer::getCalibrationSize());
+}
+
+/**
+*	Restores the accelerometer's and gyroscope's calibration data from a buffer.
+*
+*	@param data The buffer of getCalibrationSize() bytes.
+*/
+void SRL::AccelGyro::loadCalibration(const byte* data)
+{
+	Accelerometer::loadCalibration(data);
+	Gyroscope::loadCalibration(data + Accelerometer::getCalibrationSize());
+}
+
+/**
+*	Samples both sensors and updates the angles. Used by SensorHub.
+*/
+void SRL::AccelGyro::sample(void)
+{
+	update();
+}
@@ -123,6 +123,190 @@ void SRL::Accelerometer::calcAccelOffsets(uint8_t orientation, bool console, uns
 	}
 }
 
+/**
+*	Averages raw accelerometer readings on all three axes.
+*
+*	@param x Pointer to the x-axis's average.
+*	@param y Pointer to the y-axis's average.
+*	@param z Pointer to the z-axis's average.
+*	@param samples The number of readings to average.
+*/
+void SRL::Accelerometer::getRawAccelAverage(int16_t* x, int16_t* y, int16_t* z, unsigned int samples)
+{
+	long accelX = 0, accelY = 0, accelZ = 0;
+
+	for (unsigned int i = 0; i < samples; i++)
+	{
+		accelX += getRawAccelX();
+		accelY += getRawAccelY();
+		accelZ += getRawAccelZ();
+	}
+
+	*x = accelX / (long) samples;
+	*y = accelY / (long) samples;
+	*z = accelZ / (long) samples;
+}
+
+/**
+*	Calculate the accelerometer's offsets and scales from averaged raw readings
+*	taken in the six orientations. Row i of poses holds the x, y and z averages
+*	of orientation i + 1 (X_UP, X_DOWN, Y_UP, Y_DOWN, Z_UP, Z_DOWN).
+*	For the model raw = scale * g + offset the least-squares offset of an axis
+*	is the mean of its six readings, and its scale is half the difference of
+*	its up and down readings.
+*
+*	@param poses The averaged raw readings.
+*	@return Returns 0 (false) if successful, 1 (true) if the readings are implausible.
+*/
+uint8_t SRL::Accelerometer::calcAccelScales(int16_t poses[ACCEL_POSE_COUNT][3])
+{
+	int16_t offsets[3];
+	uint16_t scales[3];
+
+	for (uint8_t axis = 0; axis < 3; axis++)
+	{
+		long sum = 0;
+
+		for (uint8_t pose = 0; pose < ACCEL_POSE_COUNT; pose++)
+		{
+			sum += poses[pose][axis];
+		}
+
+		long span = (long) poses[axis * 2][axis] - poses[axis * 2 + 1][axis];
+
+		if (span <= 0)
+		{
+			return 1;
+		}
+
+		double scale = 2.0 * accelSensitivity * ACCEL_UNITY_SCALE / span;
+
+		// Limit the gain to 2, so correctAccel can not overflow
+		if (scale > 2.0 * ACCEL_UNITY_SCALE)
+		{
+			return 1;
+		}
+
+		offsets[axis] = sum / ACCEL_POSE_COUNT;
+		scales[axis] = (uint16_t) (scale + 0.5);
+	}
+
+	setAccelOffsets(offsets[0], offsets[1], offsets[2]);
+	setAccelScales(scales[0], scales[1], scales[2]);
+
+	return 0;
+}
+
+/**
+*	Calculate the accelerometer's offsets and scales using six-position
+*	calibration. Turn the sensor into each of the six orientations and hold it
+*	still until the orientation is recorded. Blocks until all six orientations
+*	have been recorded.
+*
+*	@param console Output stuff to serial on the progress of the calibration.
+*	@param iterations The number of still readings averaged in each orientation.
+*/
+void SRL::Accelerometer::calcAccelCalibration(bool console, unsigned int iterations)
+{
+	int16_t poses[ACCEL_POSE_COUNT][3];
+	uint8_t recorded = 0, last = 0;
+	unsigned int still = 0;
+	long sumX = 0, sumY = 0, sumZ = 0;
+	long tolerance = accelSensitivity / 50;
+
+	if (console)
+	{
+		Serial.println("Calibrating accelerometer. Hold it still in each of the six orientations.");
+	}
+
+	while (recorded != (1 << ACCEL_POSE_COUNT) - 1)
+	{
+		int16_t x, y, z;
+		getRawAccelAverage(&x, &y, &z);
+		uint8_t pose = detectAccelPose(x, y, z);
+
+		// Restart the average if the sensor was moved
+		if (pose != last || (still > 0 && (
+			abs(x - sumX / (long) still) > tolerance ||
+			abs(y - sumY / (long) still) > tolerance ||
+			abs(z - sumZ / (long) still) > tolerance)))
+		{
+			last = pose;
+			still = 0;
+			sumX = sumY = sumZ = 0;
+		}
+
+		if (pose == 0 || (recorded & (1 << (pose - 1))))
+		{
+			continue;
+		}
+
+		sumX += x;
+		sumY += y;
+		sumZ += z;
+
+		if (++still == iterations)
+		{
+			poses[pose - 1][0] = sumX / (long) iterations;
+			poses[pose - 1][1] = sumY / (long) iterations;
+			poses[pose - 1][2] = sumZ / (long) iterations;
+			recorded |= 1 << (pose - 1);
+
+			if (console)
+			{
+				Serial.print("Orientation "); Serial.print(pose); Serial.println(" recorded.");
+			}
+		}
+	}
+
+	uint8_t failed = calcAccelScales(poses);
+
+	if (console)
+	{
+		if (failed)
+		{
+			Serial.println("\nCalibration failed! The readings are implausible.");
+			return;
+		}
+
+		Serial.println("\nCalibration complete! Your offsets are:");
+		Serial.print("x: "); Serial.print(getAccelXOffset(), DEC);
+		Serial.print(" y: "); Serial.print(getAccelYOffset(), DEC);
+		Serial.print(" z: "); Serial.println(getAccelZOffset(), DEC);
+		Serial.println("Your scales are:");
+		Serial.print("x: "); Serial.print(getAccelXScale(), DEC);
+		Serial.print(" y: "); Serial.print(getAccelYScale(), DEC);
+		Serial.print(" z: "); Serial.println(getAccelZScale(), DEC);
+	}
+}
+
+/**
+*	Returns the orientation of the sensor based on averaged raw readings,
+*	or 0 if the sensor is not in one of the six orientations.
+*
+*	@param x The x-axis's reading.
+*	@param y The y-axis's reading.
+*	@param z The z-axis's reading.
+*/
+uint8_t SRL::Accelerometer::detectAccelPose(int16_t x, int16_t y, int16_t z)
+{
+	long axes[3] = { x, y, z };
+	long strong = accelSensitivity * 0.8;
+	long weak = accelSensitivity * 0.25;
+
+	for (uint8_t axis = 0; axis < 3; axis++)
+	{
+		if (abs(axes[axis]) > strong
+			&& abs(axes[(axis + 1) % 3]) < weak
+			&& abs(axes[(axis + 2) % 3]) < weak)
+		{
+			return axis * 2 + (axes[axis] > 0 ? X_UP : X_DOWN);
+		}
+	}
+
+	return 0;
+}
+
 /**
 *	Returns the median of raw accelerometer readings on the x-axis.
 *	Note: untested since last change.
@@ -181,32 +365,45 @@ int16_t SRL::Accelerometer::getRawAccelZMedian(unsigned int iterations)
 
 double SRL::Accelerometer::getAccelXMedian(unsigned int iterations)
 {
-	return (getRawAccelXMedian() - accelXOffset) / accelSensitivity;
+	return correctAccel(getRawAccelXMedian(iterations), accelXOffset, accelXScale) / accelSensitivity;
 }
 
 double SRL::Accelerometer::getAccelYMedian(unsigned int iterations)
 {
-	return (getRawAccelXMedian() - accelYOffset) / accelSensitivity;
+	return correctAccel(getRawAccelYMedian(iterations), accelYOffset, accelYScale) / accelSensitivity;
 }
 
 double SRL::Accelerometer::getAccelZMedian(unsigned int iterations)
 {
-	return (getRawAccelZMedian() - accelXOffset) / accelSensitivity;
+	return correctAccel(getRawAccelZMedian(iterations), accelZOffset, accelZScale) / accelSensitivity;
 }
 
 double SRL::Accelerometer::getAccelX(void)
 {
-	return (getRawAccelX() - accelXOffset) / accelSensitivity;
+	return correctAccel(getRawAccelX(), accelXOffset, accelXScale) / accelSensitivity;
 }
 
 double SRL::Accelerometer::getAccelY(void)
 {
-	return (getRawAccelY() - accelYOffset) / accelSensitivity;
+	return correctAccel(getRawAccelY(), accelYOffset, accelYScale) / accelSensitivity;
 }
 
 double SRL::Accelerometer::getAccelZ(void)
 {
-	return (getRawAccelZ() - accelZOffset) / accelSensitivity;
+	return correctAccel(getRawAccelZ(), accelZOffset, accelZScale) / accelSensitivity;
+}
+
+/**
+*	Applies the offset and scale of an axis to a raw reading.
+*	Integer multiply-add, the result is in raw units.
+*
+*	@param raw The raw reading.
+*	@param offset The axis's offset.
+*	@param scale The axis's scale in ACCEL_SCALE_SHIFT fixed point.
+*/
+int32_t SRL::Accelerometer::correctAccel(int16_t raw, int16_t offset, uint16_t scale)
+{
+	return (((int32_t) raw - offset) * scale) >> ACCEL_SCALE_SHIFT;
 }
 
 int16_t SRL::Accelerometer::getAccelXOffset(void)
@@ -238,3 +435,142 @@ void SRL::Accelerometer::setAccelZOffset(int16_t offset)
 {
 	this->accelZOffset = offset;
 }
+
+/**
+*	Set the accelerometer's scales.
+*
+*	@param x The x-axis's scale.
+*	@param y The y-axis's scale.
+*	@param z The z-axis's scale.
+*/
+void SRL::Accelerometer::setAccelScales(uint16_t x, uint16_t y, uint16_t z)
+{
+	setAccelXScale(x);
+	setAccelYScale(y);
+	setAccelZScale(z);
+}
+
+uint16_t SRL::Accelerometer::getAccelXScale(void)
+{
+	return accelXScale;
+}
+
+void SRL::Accelerometer::setAccelXScale(uint16_t scale)
+{
+	this->accelXScale = scale;
+}
+
+uint16_t SRL::Accelerometer::getAccelYScale(void)
+{
+	return accelYScale;
+}
+
+void SRL::Accelerometer::setAccelYScale(uint16_t scale)
+{
+	this->accelYScale = scale;
+}
+
+uint16_t SRL::Accelerometer::getAccelZScale(void)
+{
+	return accelZScale;
+}
+
+void SRL::Accelerometer::setAccelZScale(uint16_t scale)
+{
+	this->accelZScale = scale;
+}
+
+/**
+*	Returns the size of the accelerometer's calibration data in bytes.
+*
+*/
+uint8_t SRL::Accelerometer::getCalibrationSize(void)
+{
+	return ACCEL_CALIBRATION_SIZE;
+}
+
+/**
+*	Writes the accelerometer's offsets and scales to a buffer.
+*
+*	@param data The buffer of ACCEL_CALIBRATION_SIZE bytes.
+*/
+void SRL::Accelerometer::saveCalibration(byte* data)
+{
+	int16_t offsets[3] = { accelXOffset, accelYOffset, accelZOffset };
+	uint16_t scales[3] = { accelXScale, accelYScale, accelZScale };
+
+	memcpy(data, offsets, sizeof(offsets));
+	memcpy(data + sizeof(offsets), scales, sizeof(scales));
+}
+
+/**
+*	Restores the accelerometer's offsets and scales from a buffer.
+*
+*	@param data The buffer of ACCEL_CALIBRATION_SIZE bytes.
+*/
+void SRL::Accelerometer::loadCalibration(const byte* data)
+{
+	int16_t offsets[3];
+	uint16_t scales[3];
+
+	memcpy(offsets, data, sizeof(offsets));
+	memcpy(scales, data + sizeof(offsets), sizeof(scales));
+
+	setAccelOffsets(offsets[0], offsets[1], offsets[2]);
+	setAccelScales(scales[0], scales[1], scales[2]);
+}
+
+/**
+*	Reads the acceleration on all three axes (in g) and stamps it with the
+*	time in the middle of the reads. The sample is kept for getAccelSample().
+*
+*	@param iterations The number of readings the median is taken of. Default value: 1
+*/
+SRL::Sample<SRL::Axes> SRL::Accelerometer::sampleAccel(unsigned int iterations)
+{
+	unsigned long start = micros();
+	Axes accel;
+
+	if (iterations > 1)
+	{
+		accel.x = getAccelXMedian(iterations);
+		accel.y = getAccelYMedian(iterations);
+		accel.z = getAccelZMedian(iterations);
+	}
+	else
+	{
+		accel.x = getAccelX();
+		accel.y = getAccelY();
+		accel.z = getAccelZ();
+	}
+
+	Sample<Axes> sample(accel, start + (micros() - start) / 2);
+
+	// Executive tasks read the sample, they must not see half of it
+	SRL_ATOMIC_BEGIN();
+	accelSample = sample;
+	SRL_ATOMIC_END();
+
+	return sample;
+}
+
+/**
+*	Returns the last sample taken by sampleAccel() without reading the sensor.
+*	Safe to call from interrupts while loop() takes a new sample.
+*/
+SRL::Sample<SRL::Axes> SRL::Accelerometer::getAccelSample(void)
+{
+	SRL_ATOMIC_BEGIN();
+	Sample<Axes> sample = accelSample;
+	SRL_ATOMIC_END();
+
+	return sample;
+}
+
+/**
+*	Takes a sample of the acceleration. Used by SensorHub.
+*/
+void SRL::Accelerometer::sample(void)
+{
+	sampleAccel();
+}
@@ -30,6 +30,8 @@
 #include "Component.h"
 #include "I2C.h"
 #include "Statistics.h"
+#include "Sample.h"
+#include "Thermometer.h"
 
 #define BMP280_COMPONENT_NAME "BMP280"
 #define BMP280_DEFAULT_ADDRESS 0x78
@@ -50,9 +52,11 @@
 #define BMP280_DIG_P8 0x9C
 #define BMP280_DIG_P9 0x9E
 
+#define BMP280_CALIBRATION_SIZE 28
+
 namespace SRL
 {
-	class BMP280 : public SRL::Component, public SRL::I2CDevice
+	class BMP280 : public SRL::Thermometer, public SRL::I2CDevice
 	{
 		public:
 			BMP280(uint8_t addr = BMP280_DEFAULT_ADDRESS);
@@ -74,6 +78,15 @@ namespace SRL
 			double getMedianPressure(unsigned int samples = 5);
 			double getMedianAltitude(unsigned int samples = 5);
 			
+			Sample<double> samplePressure(void);
+			Sample<double> getPressureSample(void);
+			void sample(void);
+			
+			/* Calibration storage */
+			uint8_t getCalibrationSize(void);
+			void saveCalibration(byte* data);
+			void loadCalibration(const byte* data);
+			
 			
 			typedef enum
 			{
@@ -92,7 +105,10 @@ namespace SRL
 			} mode;
 			
 		private:
+			double compensateTemperature(byte* tbuffer);
+
 			double basePressure;
+			Sample<double> pressureSample;
 			
 			// Calibration data
 			unsigned short dig_T1, dig_P1;
@@ -0,0 +1,62 @@
+/*
+* MIT License
+*
+* Copyright (c) 2021 Robert Hutter
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+#include "CRC.h"
+
+/**
+*	Updates a CRC-16/CCITT checksum with one byte.
+*	Bitwise, so no lookup table is kept in flash.
+*
+*	@param crc The checksum so far. Start with CRC16_INIT.
+*	@param data The byte to add.
+*	@return Returns the updated checksum.
+*/
+uint16_t SRL::crc16(uint16_t crc, byte data)
+{
+	crc ^= (uint16_t) data << 8;
+
+	for (uint8_t i = 0; i < 8; i++)
+	{
+		crc = (crc & 0x8000) ? (crc << 1) ^ CRC16_POLYNOMIAL : crc << 1;
+	}
+
+	return crc;
+}
+
+/**
+*	Calculates the CRC-16/CCITT checksum of a byte array.
+*
+*	@param data The bytes.
+*	@param len The number of bytes.
+*	@param crc The checksum to continue from. Default value: CRC16_INIT
+*	@return Returns the checksum.
+*/
+uint16_t SRL::crc16(const byte* data, unsigned int len, uint16_t crc)
+{
+	for (unsigned int i = 0; i < len; i++)
+	{
+		crc = crc16(crc, data[i]);
+	}
+
+	return crc;
+}
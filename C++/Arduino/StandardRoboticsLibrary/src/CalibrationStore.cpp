@@ -0,0 +1,252 @@
+/*
+* MIT License
+*
+* Copyright (c) 2021 Robert Hutter
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+#include "CalibrationStore.h"
+
+/**
+*	Class CalibrationStore's constructor.
+*
+*	@param address The EEPROM address the calibration data starts at.
+*/
+SRL::CalibrationStore::CalibrationStore(unsigned int address)
+{
+	this->address = address;
+	this->count = 0;
+}
+
+/**
+*	Registers a component. Components are stored in the order they were added,
+*	so they must be added in the same order before save() and load().
+*
+*	@param component The component.
+*	@return Returns 0 (false) if successful, 1 (true) if the store is full or
+*	the component's calibration data is too large.
+*/
+uint8_t SRL::CalibrationStore::add(SRL::Component* component)
+{
+	if (count >= CALIBRATION_STORE_MAX_COMPONENTS
+		|| component->getCalibrationSize() > CALIBRATION_STORE_MAX_SIZE)
+	{
+		return 1;
+	}
+
+	components[count++] = component;
+	return 0;
+}
+
+/**
+*	Writes the calibration data of all registered components to EEPROM.
+*	Only bytes that changed are written.
+*
+*	@return Returns 0 (false) if successful, 1 (true) if the data does not fit.
+*/
+uint8_t SRL::CalibrationStore::save(void)
+{
+#ifdef CALIBRATION_STORE_NO_EEPROM
+	return 1;
+#else
+	if (address + getLength() > EEPROM.length())
+	{
+		return 1;
+	}
+
+	byte header[4] = { CALIBRATION_STORE_MAGIC >> 8, CALIBRATION_STORE_MAGIC & 0xFF, CALIBRATION_STORE_VERSION, count };
+	unsigned int addr = address;
+	uint16_t crc = write(addr, header, 4, CRC16_INIT);
+	addr += 4;
+
+	for (uint8_t i = 0; i < count; i++)
+	{
+		byte data[CALIBRATION_STORE_MAX_SIZE];
+		uint8_t size = components[i]->getCalibrationSize();
+		byte entry[2] = { (byte) components[i]->getType(), size };
+
+		components[i]->saveCalibration(data);
+
+		crc = write(addr, entry, 2, crc);
+		crc = write(addr + 2, data, size, crc);
+		addr += 2 + size;
+	}
+
+	EEPROM.update(addr, crc >> 8);
+	EEPROM.update(addr + 1, crc & 0xFF);
+
+	return 0;
+#endif
+}
+
+/**
+*	Restores the calibration data of all registered components from EEPROM.
+*	Nothing is restored unless the stored version, components and CRC match.
+*
+*	@return Returns 0 (false) if successful, 1 (true) if there is no valid data.
+*/
+uint8_t SRL::CalibrationStore::load(void)
+{
+#ifdef CALIBRATION_STORE_NO_EEPROM
+	return 1;
+#else
+	if (verify() != 0)
+	{
+		return 1;
+	}
+
+	unsigned int addr = address + 4;
+
+	for (uint8_t i = 0; i < count; i++)
+	{
+		byte data[CALIBRATION_STORE_MAX_SIZE];
+		uint8_t size = components[i]->getCalibrationSize();
+
+		read(addr + 2, data, size, 0);
+		components[i]->loadCalibration(data);
+		addr += 2 + size;
+	}
+
+	return 0;
+#endif
+}
+
+/**
+*	Invalidates the stored calibration data.
+*
+*/
+void SRL::CalibrationStore::clear(void)
+{
+#ifndef CALIBRATION_STORE_NO_EEPROM
+	EEPROM.update(address, 0xFF);
+	EEPROM.update(address + 1, 0xFF);
+#endif
+}
+
+/**
+*	Checks the stored header, component entries and CRC against the
+*	registered components.
+*
+*	@return Returns 0 (false) if the stored data is valid, 1 (true) if not.
+*/
+uint8_t SRL::CalibrationStore::verify(void)
+{
+#ifdef CALIBRATION_STORE_NO_EEPROM
+	return 1;
+#else
+	if (address + getLength() > EEPROM.length())
+	{
+		return 1;
+	}
+
+	byte header[4];
+	unsigned int addr = address;
+	uint16_t crc = read(addr, header, 4, CRC16_INIT);
+	addr += 4;
+
+	if (header[0] != (CALIBRATION_STORE_MAGIC >> 8) || header[1] != (CALIBRATION_STORE_MAGIC & 0xFF)
+		|| header[2] != CALIBRATION_STORE_VERSION || header[3] != count)
+	{
+		return 1;
+	}
+
+	for (uint8_t i = 0; i < count; i++)
+	{
+		byte data[CALIBRATION_STORE_MAX_SIZE];
+		byte entry[2];
+		uint8_t size = components[i]->getCalibrationSize();
+
+		crc = read(addr, entry, 2, crc);
+
+		if (entry[0] != (byte) components[i]->getType() || entry[1] != size)
+		{
+			return 1;
+		}
+
+		crc = read(addr + 2, data, size, crc);
+		addr += 2 + size;
+	}
+
+	uint16_t stored = (uint16_t) EEPROM.read(addr) << 8 | EEPROM.read(addr + 1);
+
+	return stored == crc ? 0 : 1;
+#endif
+}
+
+/**
+*	Returns the number of EEPROM bytes the registered components need.
+*
+*/
+unsigned int SRL::CalibrationStore::getLength(void)
+{
+	unsigned int len = 4 + 2;
+
+	for (uint8_t i = 0; i < count; i++)
+	{
+		len += 2 + components[i]->getCalibrationSize();
+	}
+
+	return len;
+}
+
+/**
+*	Writes bytes to EEPROM and updates the CRC.
+*
+*	@return Returns the updated CRC.
+*/
+uint16_t SRL::CalibrationStore::write(unsigned int addr, const byte* data, uint8_t len, uint16_t crc)
+{
+#ifndef CALIBRATION_STORE_NO_EEPROM
+	for (uint8_t i = 0; i < len; i++)
+	{
+		EEPROM.update(addr + i, data[i]);
+	}
+#else
+	(void) addr;
+#endif
+	return crc16(data, len, crc);
+}
+
+/**
+*	Reads bytes from EEPROM and updates the CRC.
+*
+*	@return Returns the updated CRC.
+*/
+uint16_t SRL::CalibrationStore::read(unsigned int addr, byte* data, uint8_t len, uint16_t crc)
+{
+#ifndef CALIBRATION_STORE_NO_EEPROM
+	for (uint8_t i = 0; i < len; i++)
+	{
+		data[i] = EEPROM.read(addr + i);
+	}
+#else
+	(void) addr;
+#endif
+	return crc16(data, len, crc);
+}
+
+unsigned int SRL::CalibrationStore::getAddress(void)
+{
+	return address;
+}
+
+uint8_t SRL::CalibrationStore::getCount(void)
+{
+	return count;
+}
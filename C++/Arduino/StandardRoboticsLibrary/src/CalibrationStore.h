@@ -0,0 +1,78 @@
+/*
+* MIT License
+*
+* Copyright (c) 2021 Robert Hutter
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+#ifndef _CALIBRATIONSTORE_H
+#define _CALIBRATIONSTORE_H
+
+#include "SRL.h"
+#include "Component.h"
+#include "CRC.h"
+
+#if defined(ARDUINO) && !defined(__AVR__)
+#define CALIBRATION_STORE_NO_EEPROM
+#else
+#include <EEPROM.h>
+#endif
+
+#define CALIBRATION_STORE_MAGIC 0x5352
+#define CALIBRATION_STORE_VERSION 2 // bump whenever the stored layout changes, older records are rejected
+#define CALIBRATION_STORE_MAX_COMPONENTS 8
+#define CALIBRATION_STORE_MAX_SIZE 64
+
+namespace SRL
+{
+  /**
+  * Class CalibrationStore. Keeps the calibration data of registered
+  * components in EEPROM, so they do not have to be calibrated on every boot.
+  *
+  * Layout: magic (2), version (1), count (1), then type (1), size (1) and
+  * data of each component, followed by a CRC16 of all previous bytes.
+  */
+  class CalibrationStore
+  {
+    public:
+      CalibrationStore(unsigned int address = 0);
+
+      uint8_t add(SRL::Component* component);
+
+      uint8_t save(void);
+      uint8_t load(void);
+      void clear(void);
+
+      /* Getters & setters */
+      unsigned int getAddress(void);
+      uint8_t getCount(void);
+
+    private:
+      unsigned int address;
+      uint8_t count;
+      SRL::Component* components[CALIBRATION_STORE_MAX_COMPONENTS];
+
+      unsigned int getLength(void);
+      uint8_t verify(void);
+      uint16_t write(unsigned int addr, const byte* data, uint8_t len, uint16_t crc);
+      uint16_t read(unsigned int addr, byte* data, uint8_t len, uint16_t crc);
+  };
+}
+
+#endif
@@ -0,0 +1,99 @@
+/*
+* MIT License
+*
+* Copyright (c) 2018 Robert Hutter
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+#ifndef _COMMANDTABLE_H
+#define _COMMANDTABLE_H
+
+#include "SRL.h"
+#include "SCOM.h"
+
+#define COMMAND_TABLE_SIZE 16 // slots, a power of two
+#define COMMAND_MAX_ARGUMENTS 8
+
+namespace SRL
+{
+	/**
+	*	Class Arguments. The arguments of a received command. They are views
+	*	into the receive buffer and are only parsed when asked for, so they
+	*	are valid while the command's handler runs.
+	*/
+	class Arguments
+	{
+		public:
+			uint8_t getCount(void);
+
+			long getInt(uint8_t index, long fallback = 0);
+			double getFloat(uint8_t index, double fallback = 0.0);
+			SRL::Payload getText(uint8_t index);
+
+		private:
+			const char* data[COMMAND_MAX_ARGUMENTS];
+			uint8_t length[COMMAND_MAX_ARGUMENTS];
+			uint8_t count;
+
+			friend class CommandTable;
+	};
+
+	typedef void (*CommandFunction)(void* context, SRL::Arguments& args);
+
+	/**
+	*	Class CommandTable. Calls handler functions for SCOM commands of the
+	*	form name(a,b,c); by their name. Numeric command IDs are names too.
+	*	The names are hashed into an open addressed table, so finding a
+	*	command takes at most COMMAND_TABLE_SIZE probes and one compare of
+	*	its name. Nothing is allocated or copied, the names passed to add()
+	*	must stay valid while they are in the table.
+	*/
+	class CommandTable
+	{
+		public:
+			CommandTable(void);
+
+			uint8_t add(const char* name, SRL::CommandFunction function, void* context = NULL);
+			uint8_t remove(const char* name);
+			void clear(void);
+
+			uint8_t dispatch(SRL::Payload command);
+			uint8_t dispatch(const char* command, uint8_t length);
+
+			uint8_t getCount(void);
+
+			static uint16_t hash(const char* name, uint8_t length);
+
+		private:
+			typedef struct
+			{
+				const char* name;
+				uint16_t hash;
+				SRL::CommandFunction function;
+				void* context;
+			} Entry;
+
+			Entry entries[COMMAND_TABLE_SIZE];
+			uint8_t count;
+
+			int8_t find(const char* name, uint8_t length);
+	};
+}
+
+#endif
@@ -25,7 +25,9 @@
 
 SRL::Encoder::Encoder(unsigned int c1, unsigned int c2) : Paul_Encoder(c1, c2)
 {
-
+  consumedPosition = 0;
+  velocityPosition = 0;
+  velocityTime = 0;
 }
 
 double SRL::Encoder::readCm()
@@ -38,6 +40,95 @@ double SRL::Encoder::readMm(void)
   return readCm() * 10;
 }
 
+/**
+* Sets the encoder's position. The velocity and the delta not yet consumed
+* are not affected. No step counted meanwhile is lost, as the position is
+* read and written in one critical section.
+*
+* @param steps The new position in steps.
+*/
+void SRL::Encoder::write(int32_t steps)
+{
+  SRL_ATOMIC_BEGIN();
+
+  uint32_t shift = (uint32_t) steps - (uint32_t) peek();
+  consumedPosition += shift;
+  velocityPosition += shift;
+  poke(steps);
+
+  SRL_ATOMIC_END();
+}
+
+/**
+* Returns the steps counted since the last consumed delta, without consuming them.
+*/
+long SRL::Encoder::readDelta(void)
+{
+  // Unsigned subtraction keeps the delta right when the position wraps around
+  return (int32_t) ((uint32_t) read() - consumedPosition);
+}
+
+/**
+* Returns the steps counted since the last consumed delta and consumes them.
+* The position keeps running, so no steps are lost between calls.
+*/
+long SRL::Encoder::consumeDelta(void)
+{
+  uint32_t position = read();
+  long delta = (int32_t) (position - consumedPosition);
+
+  consumedPosition = position;
+  return delta;
+}
+
+/**
+* Returns the distance travelled since the last consumed delta in cm and consumes it.
+*/
+double SRL::Encoder::consumeCm(void)
+{
+  return convertCm(consumeDelta());
+}
+
+/**
+* Reads the positions of several encoders at the same instant.
+*
+* @param encoders The encoders to read.
+* @param positions Array of count positions to write to.
+* @param count The number of encoders.
+*/
+void SRL::Encoder::snapshot(Encoder** encoders, long* positions, uint8_t count)
+{
+  SRL_ATOMIC_BEGIN();
+
+  for (uint8_t i = 0; i < count; i++)
+  {
+    positions[i] = encoders[i]->peek();
+  }
+
+  SRL_ATOMIC_END();
+}
+
+/**
+* Consumes the deltas of several encoders at the same instant, so the
+* deltas cover exactly the same time span.
+*
+* @param encoders The encoders to read.
+* @param deltas Array of count deltas to write to.
+* @param count The number of encoders.
+*/
+void SRL::Encoder::consumeAll(Encoder** encoders, long* deltas, uint8_t count)
+{
+  snapshot(encoders, deltas, count);
+
+  for (uint8_t i = 0; i < count; i++)
+  {
+    uint32_t position = deltas[i];
+
+    deltas[i] = (int32_t) (position - encoders[i]->consumedPosition);
+    encoders[i]->consumedPosition = position;
+  }
+}
+
 void SRL::Encoder::writeCm(double cm)
 {
   write(convertSteps(cm));
@@ -47,3 +138,99 @@ void SRL::Encoder::writeMm(double mm)
 {
   writeCm(mm / 10);
 }
+
+/**
+* Reads the encoder's position and stamps it with the time of the read.
+* The sample is kept for getCountSample().
+*/
+SRL::Sample<long> SRL::Encoder::sampleCount(void)
+{
+  long count = read();
+  countSample = Sample<long>(count, micros());
+  return countSample;
+}
+
+/**
+* Returns the last sample taken by sampleCount() without reading the encoder.
+*/
+SRL::Sample<long> SRL::Encoder::getCountSample(void)
+{
+  return countSample;
+}
+
+/**
+* Estimates the velocity in steps per second from the edge times captured
+* by the interrupts. Once ENCODER_VELOCITY_MIN_STEPS steps have passed since
+* the previous measurement, the steps are divided by the time between their
+* edges. At lower speeds, and on the first steps after standing still, the
+* time between the last two edges is used, bounded by the time since the
+* last edge while the wheel slows down. Without edges for
+* ENCODER_VELOCITY_TIMEOUT us the velocity is 0. The velocity is an integer,
+* so speed control in interrupts needs no float math.
+* The sample is kept for getVelocitySample().
+*/
+SRL::Sample<long> SRL::Encoder::sampleVelocity(void)
+{
+  int32_t position;
+  uint32_t edgeTime, edgePeriod;
+  int8_t direction;
+
+  readEdges(&position, &edgeTime, &edgePeriod, &direction);
+  unsigned long now = micros();
+  unsigned long idle = now - edgeTime;
+  long steps = (int32_t) ((uint32_t) position - (uint32_t) velocityPosition);
+  long velocity = 0;
+
+  if (edgeTime == 0 || idle > ENCODER_VELOCITY_TIMEOUT)
+  {
+    velocity = 0;
+  }
+  else if (abs(steps) >= ENCODER_VELOCITY_MIN_STEPS && edgeTime - velocityTime <= ENCODER_VELOCITY_TIMEOUT)
+  {
+    long span = (long) (edgeTime - velocityTime);
+
+    // Steps times 10^6 fits in 32 bits up to 2147 steps
+    if (labs(steps) <= 2147)
+      velocity = steps * 1000000L / span;
+    else
+      velocity = (long) ((int64_t) steps * 1000000L / span);
+  }
+  else if (edgePeriod != 0)
+  {
+    velocity = direction * 1000000L / (long) ((idle > edgePeriod) ? idle : edgePeriod);
+  }
+
+  if (abs(steps) >= ENCODER_VELOCITY_MIN_STEPS || idle > ENCODER_VELOCITY_TIMEOUT)
+  {
+    velocityPosition = position;
+    velocityTime = edgeTime;
+  }
+
+  velocitySample = Sample<long>(velocity, now);
+  return velocitySample;
+}
+
+/**
+* Returns the last sample taken by sampleVelocity() without reading the encoder.
+*/
+SRL::Sample<long> SRL::Encoder::getVelocitySample(void)
+{
+  return velocitySample;
+}
+
+/**
+* Returns the velocity of the last sample in cm/s.
+*/
+double SRL::Encoder::getVelocityCm(void)
+{
+  return (double) velocitySample.value * convertCm(ENCODER_VELOCITY_SCALE) / ENCODER_VELOCITY_SCALE;
+}
+
+/**
+* Takes a sample of the position and the velocity. Used by SensorHub.
+*/
+void SRL::Encoder::sample(void)
+{
+  sampleCount();
+  sampleVelocity();
+}
@@ -27,9 +27,17 @@
 #include "SRL.h"
 #include "Component.h"
 #include "Paul_encoder.h"
+#include "Sample.h"
+
+#define ENCODER_VELOCITY_MIN_STEPS 4
+#define ENCODER_VELOCITY_TIMEOUT 250000
+#define ENCODER_VELOCITY_SCALE 1000
 
 namespace SRL
 {
+  /**
+  * Class Encoder. A rotary encoder measuring the position and velocity of a wheel.
+  */
   class Encoder : public Paul_Encoder, public virtual SRL::Component
   {
     public:
@@ -38,11 +46,38 @@ namespace SRL
       double readCm(void);
       double readMm(void);
 
+      void write(int32_t steps);
       void writeCm(double cm);
       void writeMm(double mm);
 
+      long readDelta(void);
+      long consumeDelta(void);
+      double consumeCm(void);
+
+      static void snapshot(Encoder** encoders, long* positions, uint8_t count);
+      static void consumeAll(Encoder** encoders, long* deltas, uint8_t count);
+
+      Sample<long> sampleVelocity(void);
+      Sample<long> getVelocitySample(void);
+      double getVelocityCm(void);
+
+      Sample<long> sampleCount(void);
+      Sample<long> getCountSample(void);
+      void sample(void);
+
       virtual long convertSteps(double cm) = 0;
       virtual double convertCm(long steps) = 0;
+
+    protected:
+      Sample<long> countSample;
+      Sample<long> velocitySample;
+
+      // Position the last consumed delta ended at
+      uint32_t consumedPosition;
+
+      // Edge the last multi-step velocity was measured from
+      long velocityPosition;
+      unsigned long velocityTime;
   };
 }
 #endif
@@ -0,0 +1,408 @@
+/*
+* MIT License
+*
+* Copyright (c) 2018 Robert Hutter
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+#include "Executive.h"
+
+SRL::Executive::Task SRL::Executive::tasks[EXECUTIVE_MAX_TASKS];
+uint8_t SRL::Executive::count = 0;
+unsigned int SRL::Executive::level = 0;
+unsigned long SRL::Executive::ticks = 0;
+bool SRL::Executive::running = false;
+bool SRL::Executive::timer1 = false;
+
+/**
+*	Registers a periodic task. Registering a function and context again
+*	replaces the earlier registration. Must not be called from a task.
+*
+*	@param function The function to call.
+*	@param context The argument passed to the function.
+*	@param period The time between two runs in micro seconds, rounded to
+*	whole EXECUTIVE_TICK periods.
+*	@param priority Higher priority tasks run first and preempt lower ones.
+*	@return
+*	Returns the task's index, -1 if the executive is full.
+*/
+int8_t SRL::Executive::add(SRL::TaskFunction function, void* context, unsigned long period, uint8_t priority)
+{
+	remove(function, context);
+
+	if (count >= EXECUTIVE_MAX_TASKS)
+	{
+		return -1;
+	}
+
+	unsigned long periodTicks = (period + EXECUTIVE_TICK / 2) / EXECUTIVE_TICK;
+
+	if (periodTicks == 0)
+	{
+		periodTicks = 1;
+	}
+	else if (periodTicks > 0xFFFF)
+	{
+		periodTicks = 0xFFFF;
+	}
+
+	SRL_ATOMIC_BEGIN();
+
+	// Keep the tasks ordered by priority, the dispatcher relies on it
+	uint8_t i = count;
+
+	while (i > 0 && tasks[i - 1].priority < priority)
+	{
+		tasks[i] = tasks[i - 1];
+		i--;
+	}
+
+	Task* task = &tasks[i];
+	task->function = function;
+	task->context = context;
+	task->period = (unsigned int) periodTicks;
+	task->countdown = (unsigned int) periodTicks;
+	task->priority = priority;
+	task->pending = false;
+	task->running = false;
+	task->release = 0;
+	task->runs = 0;
+	task->overruns = 0;
+	task->maxJitter = 0;
+	task->maxDuration = 0;
+	count++;
+
+	SRL_ATOMIC_END();
+
+	return i;
+}
+
+/**
+*	Unregisters a task. Must not be called from a task.
+*
+*	@return
+*	Returns 0 if successful, 1 if the task is not registered.
+*/
+uint8_t SRL::Executive::remove(SRL::TaskFunction function, void* context)
+{
+	SRL_ATOMIC_BEGIN();
+
+	int8_t index = find(function, context);
+
+	if (index < 0)
+	{
+		SRL_ATOMIC_END();
+		return 1;
+	}
+
+	for (uint8_t i = index; i + 1 < count; i++)
+	{
+		tasks[i] = tasks[i + 1];
+	}
+
+	count--;
+	SRL_ATOMIC_END();
+
+	return 0;
+}
+
+/**
+*	Returns the index of a task, -1 if it is not registered.
+*
+*/
+int8_t SRL::Executive::find(SRL::TaskFunction function, void* context)
+{
+	for (uint8_t i = 0; i < count; i++)
+	{
+		if (tasks[i].function == function && tasks[i].context == context)
+		{
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+/**
+*	Starts releasing tasks, from timer 1 if EXECUTIVE_USE_TIMER1 attached
+*	it. Tasks are released one period after they were added or the
+*	executive was started.
+*/
+void SRL::Executive::begin(void)
+{
+	SRL_ATOMIC_BEGIN();
+
+	for (uint8_t i = 0; i < count; i++)
+	{
+		tasks[i].countdown = tasks[i].period;
+		tasks[i].pending = false;
+	}
+
+#if defined(EXECUTIVE_TIMER1)
+	if (timer1)
+	{
+		// Clear timer on compare match, prescaler 8
+		TCCR1A = 0;
+		TCCR1B = _BV(WGM12) | _BV(CS11);
+		TCNT1 = 0;
+		OCR1A = EXECUTIVE_TIMER_TOP;
+		TIFR1 = _BV(OCF1A);
+		TIMSK1 |= _BV(OCIE1A);
+	}
+#endif
+
+	running = true;
+	SRL_ATOMIC_END();
+}
+
+/**
+*	Stops the timer interrupt. Running tasks finish, no new ones are released.
+*
+*/
+void SRL::Executive::end(void)
+{
+	SRL_ATOMIC_BEGIN();
+
+#if defined(EXECUTIVE_TIMER1)
+	if (timer1)
+	{
+		TIMSK1 &= ~_BV(OCIE1A);
+	}
+#endif
+
+	running = false;
+	SRL_ATOMIC_END();
+}
+
+/**
+*	Releases the tasks that are due and runs them. Called from the timer
+*	interrupt every EXECUTIVE_TICK micro seconds, with interrupts disabled.
+*	A task released again before its previous run finished counts as an
+*	overrun. A task still waiting to run is released only once.
+*/
+void SRL::Executive::tick(void)
+{
+	if (!running)
+	{
+		return;
+	}
+
+	unsigned long now = micros();
+	ticks++;
+
+	for (uint8_t i = 0; i < count; i++)
+	{
+		Task* task = &tasks[i];
+
+		if (--task->countdown != 0)
+		{
+			continue;
+		}
+
+		task->countdown = task->period;
+
+		if (task->pending || task->running)
+		{
+			task->overruns++;
+		}
+
+		if (!task->pending)
+		{
+			task->pending = true;
+			task->release = now;
+		}
+	}
+
+	dispatch();
+}
+
+/**
+*	Runs the pending tasks with a higher priority than the one interrupted,
+*	highest priority first. Interrupts are enabled while a task runs, so a
+*	nested tick() can preempt it with a higher priority task.
+*/
+void SRL::Executive::dispatch(void)
+{
+	unsigned int interrupted = level;
+	uint8_t i = 0;
+
+	while (i < count && tasks[i].priority >= interrupted)
+	{
+		Task* task = &tasks[i];
+
+		if (!task->pending)
+		{
+			i++;
+			continue;
+		}
+
+		task->pending = false;
+		task->running = true;
+		level = task->priority + 1;
+
+		unsigned long start = micros();
+
+		if (start - task->release > task->maxJitter)
+		{
+			task->maxJitter = start - task->release;
+		}
+
+		interrupts();
+		task->function(task->context);
+		noInterrupts();
+
+		unsigned long duration = micros() - start;
+
+		if (duration > task->maxDuration)
+		{
+			task->maxDuration = duration;
+		}
+
+		task->running = false;
+		task->runs++;
+		level = interrupted;
+
+		// Tasks of the same or lower priority may have been released meanwhile
+		i = 0;
+	}
+}
+
+/**
+*	Resets the tick count and the counters of every task.
+*
+*/
+void SRL::Executive::resetCounters(void)
+{
+	SRL_ATOMIC_BEGIN();
+
+	ticks = 0;
+
+	for (uint8_t i = 0; i < count; i++)
+	{
+		tasks[i].runs = 0;
+		tasks[i].overruns = 0;
+		tasks[i].maxJitter = 0;
+		tasks[i].maxDuration = 0;
+	}
+
+	SRL_ATOMIC_END();
+}
+
+/**
+*	Lets begin() drive the executive from timer 1. Called before setup() when
+*	a sketch defines EXECUTIVE_USE_TIMER1, which also defines the timer's
+*	interrupt vector.
+*
+*	@return
+*	Returns true.
+*/
+bool SRL::Executive::attachTimer1(void)
+{
+	timer1 = true;
+	return true;
+}
+
+bool SRL::Executive::isRunning(void)
+{
+	return running;
+}
+
+uint8_t SRL::Executive::getCount(void)
+{
+	return count;
+}
+
+/**
+*	Returns the number of timer interrupts since the executive was started.
+*
+*/
+unsigned long SRL::Executive::getTicks(void)
+{
+	SRL_ATOMIC_BEGIN();
+	unsigned long ticks = SRL::Executive::ticks;
+	SRL_ATOMIC_END();
+
+	return ticks;
+}
+
+/**
+*	Returns a task's period in micro seconds.
+*
+*/
+unsigned long SRL::Executive::getPeriod(uint8_t index)
+{
+	return (unsigned long) tasks[index].period * EXECUTIVE_TICK;
+}
+
+uint8_t SRL::Executive::getPriority(uint8_t index)
+{
+	return tasks[index].priority;
+}
+
+/**
+*	Returns the number of times a task finished running.
+*
+*/
+unsigned long SRL::Executive::getRuns(uint8_t index)
+{
+	SRL_ATOMIC_BEGIN();
+	unsigned long runs = tasks[index].runs;
+	SRL_ATOMIC_END();
+
+	return runs;
+}
+
+/**
+*	Returns the number of times a task was released before its previous
+*	run finished.
+*/
+unsigned int SRL::Executive::getOverruns(uint8_t index)
+{
+	SRL_ATOMIC_BEGIN();
+	unsigned int overruns = tasks[index].overruns;
+	SRL_ATOMIC_END();
+
+	return overruns;
+}
+
+/**
+*	Returns the longest time a task waited between its release and its
+*	start, in micro seconds.
+*/
+unsigned long SRL::Executive::getMaxJitter(uint8_t index)
+{
+	SRL_ATOMIC_BEGIN();
+	unsigned long jitter = tasks[index].maxJitter;
+	SRL_ATOMIC_END();
+
+	return jitter;
+}
+
+/**
+*	Returns the longest time between a task's start and finish, including
+*	the time it was preempted, in micro seconds.
+*/
+unsigned long SRL::Executive::getMaxDuration(uint8_t index)
+{
+	SRL_ATOMIC_BEGIN();
+	unsigned long duration = tasks[index].maxDuration;
+	SRL_ATOMIC_END();
+
+	return duration;
+}
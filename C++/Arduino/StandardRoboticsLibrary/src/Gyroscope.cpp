@@ -23,6 +23,13 @@
 */
 #include "Gyroscope.h"
 
+SRL::Gyroscope::Gyroscope(void)
+{
+	gyroThermometer = NULL;
+	gyroBiasTemp = 0;
+	resetGyroBias();
+}
+
 /**
 *	Set the gyroscope's offsets.
 *
@@ -76,6 +83,9 @@ void SRL::Gyroscope::calcGyroOffsets(bool console, unsigned int iterations)
 		);
 	}
 
+	// The offsets were measured at the current temperature
+	resetGyroBias();
+
 	if (console)
 	{
 		Serial.print("\nYour gyro offsets are: ");
@@ -91,17 +101,20 @@ void SRL::Gyroscope::calcGyroOffsets(bool console, unsigned int iterations)
 
 double SRL::Gyroscope::getGyroX(void)
 {
-	return (getRawGyroX() - gyroXOffset) / gyroSensitivity;
+	int16_t raw = getRawGyroX();
+	return (raw - getGyroXBias()) / gyroSensitivity;
 }
 
 double SRL::Gyroscope::getGyroY(void)
 {
-	return (getRawGyroY() - gyroYOffset) / gyroSensitivity;
+	int16_t raw = getRawGyroY();
+	return (raw - getGyroYBias()) / gyroSensitivity;
 }
 
 double SRL::Gyroscope::getGyroZ(void)
 {
-	return (getRawGyroZ() - gyroXOffset) / gyroSensitivity;
+	int16_t raw = getRawGyroZ();
+	return (raw - getGyroZBias()) / gyroSensitivity;
 }
 
 /**
@@ -162,17 +175,20 @@ int16_t SRL::Gyroscope::getRawGyroZMedian(unsigned int iterations)
 
 double SRL::Gyroscope::getGyroXMedian(unsigned int iterations)
 {
-	return (getRawGyroXMedian() - gyroXOffset) / gyroSensitivity;
+	int16_t raw = getRawGyroXMedian(iterations);
+	return (raw - getGyroXBias()) / gyroSensitivity;
 }
 
 double SRL::Gyroscope::getGyroYMedian(unsigned int iterations)
 {
-	return (getRawGyroYMedian() - gyroXOffset) / gyroSensitivity;
+	int16_t raw = getRawGyroYMedian(iterations);
+	return (raw - getGyroYBias()) / gyroSensitivity;
 }
 
 double SRL::Gyroscope::getGyroZMedian(unsigned int iterations)
 {
-	return (getRawGyroZMedian() - gyroXOffset) / gyroSensitivity;
+	int16_t raw = getRawGyroZMedian(iterations);
+	return (raw - getGyroZBias()) / gyroSensitivity;
 }
 
 int16_t SRL::Gyroscope::getGyroXOffset(void)
@@ -204,3 +220,359 @@ void SRL::Gyroscope::setGyroZOffset(int16_t offset)
 {
 	this->gyroZOffset = offset;
 }
+
+/**
+*	Returns the size of the gyroscope's calibration data in bytes.
+*
+*/
+uint8_t SRL::Gyroscope::getCalibrationSize(void)
+{
+	return GYRO_CALIBRATION_SIZE;
+}
+
+/**
+*	Writes the gyroscope's offsets and temperature model to a buffer.
+*
+*	@param data The buffer of GYRO_CALIBRATION_SIZE bytes.
+*/
+void SRL::Gyroscope::saveCalibration(byte* data)
+{
+	int16_t offsets[3] = { gyroXOffset, gyroYOffset, gyroZOffset };
+	memcpy(data, offsets, sizeof(offsets));
+	memcpy(data + sizeof(offsets), &gyroBiasTemp, sizeof(gyroBiasTemp));
+	memcpy(data + sizeof(offsets) + sizeof(gyroBiasTemp), gyroBias, sizeof(gyroBias));
+}
+
+/**
+*	Restores the gyroscope's offsets and temperature model from a buffer.
+*	Learning continues from the restored model.
+*
+*	@param data The buffer of GYRO_CALIBRATION_SIZE bytes.
+*/
+void SRL::Gyroscope::loadCalibration(const byte* data)
+{
+	int16_t offsets[3];
+	memcpy(offsets, data, sizeof(offsets));
+	memcpy(&gyroBiasTemp, data + sizeof(offsets), sizeof(gyroBiasTemp));
+	memcpy(gyroBias, data + sizeof(offsets) + sizeof(gyroBiasTemp), sizeof(gyroBias));
+	setGyroOffsets(offsets[0], offsets[1], offsets[2]);
+
+	gyroBiasOrder = 0;
+	for (uint8_t axis = 0; axis < 3; axis++)
+	{
+		if (gyroBias[axis][2] != 0)
+		{
+			gyroBiasOrder = 2;
+		}
+		else if (gyroBias[axis][1] != 0 && gyroBiasOrder < 1)
+		{
+			gyroBiasOrder = 1;
+		}
+	}
+
+	clearGyroBiasSums();
+}
+
+/**
+*	Reads the angular rate on all three axes (in degrees/s) and stamps it with
+*	the time in the middle of the reads. The sample is kept for getGyroSample().
+*
+*	@param iterations The number of readings the median is taken of. Default value: 1
+*/
+SRL::Sample<SRL::Axes> SRL::Gyroscope::sampleGyro(unsigned int iterations)
+{
+	unsigned long start = micros();
+	Axes gyro;
+
+	if (iterations > 1)
+	{
+		gyro.x = getGyroXMedian(iterations);
+		gyro.y = getGyroYMedian(iterations);
+		gyro.z = getGyroZMedian(iterations);
+	}
+	else
+	{
+		gyro.x = getGyroX();
+		gyro.y = getGyroY();
+		gyro.z = getGyroZ();
+	}
+
+	Sample<Axes> sample(gyro, start + (micros() - start) / 2);
+
+	// Executive tasks read the sample, they must not see half of it
+	SRL_ATOMIC_BEGIN();
+	gyroSample = sample;
+	SRL_ATOMIC_END();
+
+	return sample;
+}
+
+/**
+*	Returns the last sample taken by sampleGyro() without reading the sensor.
+*	Safe to call from interrupts while loop() takes a new sample.
+*/
+SRL::Sample<SRL::Axes> SRL::Gyroscope::getGyroSample(void)
+{
+	SRL_ATOMIC_BEGIN();
+	Sample<Axes> sample = gyroSample;
+	SRL_ATOMIC_END();
+
+	return sample;
+}
+
+/**
+*	Takes a sample of the angular rate. Used by SensorHub.
+*/
+void SRL::Gyroscope::sample(void)
+{
+	sampleGyro();
+}
+
+/**
+*	Takes readings while the sensor stands still and refits the temperature
+*	model of the bias with them. Call it whenever the vehicle is known to be
+*	stationary, e.g. while its motors are stopped. The constant term is refit
+*	from the first reading, the linear term once the readings span
+*	GYRO_BIAS_LINEAR_SPAN degrees and the quadratic term once they span
+*	GYRO_BIAS_QUADRATIC_SPAN degrees.
+*
+*	@param threshold The largest spread of raw readings still counted as standing still.
+*	@return Returns 0 if the model was updated, 1 if the sensor moved or has no thermometer.
+*/
+uint8_t SRL::Gyroscope::learnGyroBias(int16_t threshold)
+{
+	if (gyroThermometer == NULL)
+	{
+		return 1;
+	}
+
+	long sums[3] = { 0, 0, 0 };
+	int16_t low[3], high[3];
+
+	for (unsigned int i = 0; i < GYRO_CALIBRATION_I; i++)
+	{
+		int16_t raw[3] = { getRawGyroX(), getRawGyroY(), getRawGyroZ() };
+
+		for (uint8_t axis = 0; axis < 3; axis++)
+		{
+			sums[axis] += raw[axis];
+
+			if (i == 0 || raw[axis] < low[axis])
+			{
+				low[axis] = raw[axis];
+			}
+			if (i == 0 || raw[axis] > high[axis])
+			{
+				high[axis] = raw[axis];
+			}
+		}
+	}
+
+	for (uint8_t axis = 0; axis < 3; axis++)
+	{
+		if (high[axis] - low[axis] > threshold)
+		{
+			return 1;
+		}
+	}
+
+	// Without temperature terms the reference can move to the first reading
+	if (getGyroBiasPoints() == 0 && gyroBiasOrder == 0)
+	{
+		gyroBiasTemp = getGyroTemp();
+	}
+
+	float dt = getGyroTemp() - gyroBiasTemp;
+	float power = 1;
+
+	for (uint8_t k = 0; k < 5; k++)
+	{
+		gyroTempSums[k] += power;
+
+		if (k < 3)
+		{
+			for (uint8_t axis = 0; axis < 3; axis++)
+			{
+				gyroBiasSums[axis][k] += power * sums[axis] / (float) GYRO_CALIBRATION_I;
+			}
+		}
+
+		power *= dt;
+	}
+
+	if (gyroTempSums[0] == 1 || dt < gyroMinTemp)
+	{
+		gyroMinTemp = dt;
+	}
+	if (gyroTempSums[0] == 1 || dt > gyroMaxTemp)
+	{
+		gyroMaxTemp = dt;
+	}
+
+	fitGyroBias();
+	return 0;
+}
+
+/**
+*	Solves the least squares fit of the bias on each axis. Terms the readings
+*	do not span enough temperature for keep their previous values.
+*/
+void SRL::Gyroscope::fitGyroBias(void)
+{
+	float* S = gyroTempSums;
+	float span = gyroMaxTemp - gyroMinTemp;
+	uint8_t order = (span >= GYRO_BIAS_QUADRATIC_SPAN) ? 2 : (span >= GYRO_BIAS_LINEAR_SPAN) ? 1 : 0;
+	int16_t* offsets[3] = { &gyroXOffset, &gyroYOffset, &gyroZOffset };
+
+	float det2 = S[0] * S[2] - S[1] * S[1];
+	float det3 = S[0] * (S[2] * S[4] - S[3] * S[3]) - S[1] * (S[1] * S[4] - S[3] * S[2]) + S[2] * (S[1] * S[3] - S[2] * S[2]);
+
+	if (order == 2 && det3 <= 1e-6 * S[0] * S[2] * S[4])
+	{
+		order = 1;
+	}
+	if (order == 1 && det2 <= 1e-6 * S[0] * S[2])
+	{
+		order = 0;
+	}
+
+	for (uint8_t axis = 0; axis < 3; axis++)
+	{
+		float* B = gyroBiasSums[axis];
+		float* c = gyroBias[axis];
+		float c0;
+
+		if (order == 2)
+		{
+			c0 = (B[0] * (S[2] * S[4] - S[3] * S[3]) - S[1] * (B[1] * S[4] - S[3] * B[2]) + S[2] * (B[1] * S[3] - S[2] * B[2])) / det3;
+			c[1] = (S[0] * (B[1] * S[4] - B[2] * S[3]) - B[0] * (S[1] * S[4] - S[3] * S[2]) + S[2] * (S[1] * B[2] - B[1] * S[2])) / det3;
+			c[2] = (S[0] * (S[2] * B[2] - S[3] * B[1]) - S[1] * (S[1] * B[2] - B[1] * S[2]) + B[0] * (S[1] * S[3] - S[2] * S[2])) / det3;
+		}
+		else if (order == 1)
+		{
+			// Fit the lower terms to what the kept quadratic term leaves
+			float B0 = B[0] - c[2] * S[2];
+			float B1 = B[1] - c[2] * S[3];
+
+			c0 = (B0 * S[2] - S[1] * B1) / det2;
+			c[1] = (S[0] * B1 - S[1] * B0) / det2;
+		}
+		else
+		{
+			c0 = (B[0] - c[1] * S[1] - c[2] * S[2]) / S[0];
+		}
+
+		// Keep the whole part in the offset, the fraction in the model
+		*offsets[axis] = (int16_t) floor(c0 + 0.5);
+		c[0] = c0 - *offsets[axis];
+	}
+
+	if (order > gyroBiasOrder)
+	{
+		gyroBiasOrder = order;
+	}
+}
+
+/**
+*	Clears the temperature model and moves its reference to the current
+*	temperature. The offsets are kept.
+*/
+void SRL::Gyroscope::resetGyroBias(void)
+{
+	gyroBiasTemp = getGyroTemp();
+	gyroBiasOrder = 0;
+	memset(gyroBias, 0, sizeof(gyroBias));
+	clearGyroBiasSums();
+}
+
+void SRL::Gyroscope::clearGyroBiasSums(void)
+{
+	memset(gyroTempSums, 0, sizeof(gyroTempSums));
+	memset(gyroBiasSums, 0, sizeof(gyroBiasSums));
+	gyroMinTemp = 0;
+	gyroMaxTemp = 0;
+}
+
+/**
+*	Returns the bias of an axis at the current temperature.
+*
+*	@param offset The offset of the axis.
+*	@param axis The index of the axis, 0 is x.
+*/
+double SRL::Gyroscope::getGyroBias(int16_t offset, uint8_t axis)
+{
+	float dt = getGyroTemp() - gyroBiasTemp;
+	return offset + gyroBias[axis][0] + dt * (gyroBias[axis][1] + dt * gyroBias[axis][2]);
+}
+
+/**
+*	Returns the temperature the bias is evaluated at. Without a thermometer
+*	it is the reference temperature, so only the offsets apply.
+*
+*/
+float SRL::Gyroscope::getGyroTemp(void)
+{
+	if (gyroThermometer == NULL || gyroThermometer->getTemperatureCount() == 0)
+	{
+		return gyroBiasTemp;
+	}
+
+	return gyroThermometer->getAverageTemperature();
+}
+
+double SRL::Gyroscope::getGyroXBias(void)
+{
+	return getGyroBias(gyroXOffset, 0);
+}
+
+double SRL::Gyroscope::getGyroYBias(void)
+{
+	return getGyroBias(gyroYOffset, 1);
+}
+
+double SRL::Gyroscope::getGyroZBias(void)
+{
+	return getGyroBias(gyroZOffset, 2);
+}
+
+SRL::Thermometer* SRL::Gyroscope::getGyroThermometer(void)
+{
+	return gyroThermometer;
+}
+
+/**
+*	Sets the thermometer that measures the gyroscope's die temperature.
+*
+*	@param thermometer The thermometer, NULL disables temperature compensation.
+*/
+void SRL::Gyroscope::setGyroThermometer(Thermometer* thermometer)
+{
+	gyroThermometer = thermometer;
+}
+
+/**
+*	Returns the temperature the model's terms are relative to.
+*
+*/
+float SRL::Gyroscope::getGyroBiasTemp(void)
+{
+	return gyroBiasTemp;
+}
+
+/**
+*	Returns the highest temperature term fit so far: 0 constant, 1 linear, 2 quadratic.
+*
+*/
+uint8_t SRL::Gyroscope::getGyroBiasOrder(void)
+{
+	return gyroBiasOrder;
+}
+
+/**
+*	Returns the number of stationary readings the model was fit to.
+*
+*/
+unsigned int SRL::Gyroscope::getGyroBiasPoints(void)
+{
+	return (unsigned int) gyroTempSums[0];
+}
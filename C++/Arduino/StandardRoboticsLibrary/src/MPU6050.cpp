@@ -32,7 +32,13 @@
 */
 SRL::MPU6050::MPU6050(uint8_t address, float aC, float gC) : I2CDevice(address), Component(MPU6050_COMPONENT_NAME, Component::ACCEL_GYRO), AccelGyro(aC, gC)
 {
+	// Every channel counts as used, so the first read fetches a burst
+	consumed = (1 << MPU6050_BURST_CHANNELS) - 1;
+	burstTime = 0;
+	readStatus = 0;
 
+	// The die temperature read with the gyroscope compensates its bias
+	setGyroThermometer(this);
 }
 
 /**
@@ -49,6 +55,7 @@ void SRL::MPU6050::initialize(void)
 		setGyroSensitivity(0);
 
 		setAccelOffsets(0, 0, 0);
+		setAccelScales(ACCEL_UNITY_SCALE, ACCEL_UNITY_SCALE, ACCEL_UNITY_SCALE);
 		setGyroOffsets(0, 0, 0);
 }
 
@@ -132,42 +139,113 @@ uint8_t SRL::MPU6050::setGyroSensitivity(uint8_t setting)
 	return writeBits(MPU6050_GYRO_CONFIG, MPU6050_GYRO_CONFIG_FS_SEL_BIT, MPU6050_GYRO_CONFIG_FS_SEL_LENGTH, setting);
 }
 
+/**
+*	Reads the accelerometer, temperature and gyroscope registers in one
+*	transaction and records the temperature.
+*
+*	@return Returns 0 if successful, 1 if not. On failure the previous burst is
+*	kept and the failure is recorded for getReadStatus().
+*/
+uint8_t SRL::MPU6050::readBurst(void)
+{
+	byte buff[MPU6050_BURST_LENGTH];
+	unsigned long start = micros();
+
+	if (readBytes(MPU6050_BURST_DATA, buff, MPU6050_BURST_LENGTH) != 0)
+	{
+		readStatus = 1;
+		return 1;
+	}
+
+	for (uint8_t i = 0; i < MPU6050_BURST_CHANNELS; i++)
+	{
+		burst[i] = (int16_t) (buff[2 * i] << 8 | buff[2 * i + 1]);
+	}
+
+	consumed = 0;
+	burstTime = start;
+	recordTemperature(convertTemp(burst[3]), start);
+
+	return 0;
+}
+
+/**
+*	Returns a channel of the burst, reading a new burst if the channel was
+*	already returned from the current one or the burst is too old.
+*
+*	@param channel Index of the register pair after MPU6050_BURST_DATA.
+*/
+int16_t SRL::MPU6050::readChannel(uint8_t channel)
+{
+	if ((consumed & (1 << channel)) || micros() - burstTime >= MPU6050_BURST_MAX_AGE)
+	{
+		readBurst();
+	}
+
+	consumed |= 1 << channel;
+	return burst[channel];
+}
+
+double SRL::MPU6050::convertTemp(int16_t raw)
+{
+	return (raw + MPU6050_TEMP_BIAS) / (double) MPU6050_TEMP_DIVISOR;
+}
+
 int16_t SRL::MPU6050::getRawAccelX(void)
 {
-	return readInt16_t(MPU6050_ACCELX_DATA);
+	return readChannel(0);
 }
 
 int16_t SRL::MPU6050::getRawAccelY(void)
 {
-	return readInt16_t(MPU6050_ACCELY_DATA);
+	return readChannel(1);
 }
 
 int16_t SRL::MPU6050::getRawAccelZ(void)
 {
-	return readInt16_t(MPU6050_ACCELZ_DATA);
+	return readChannel(2);
 }
 
 int16_t SRL::MPU6050::getRawGyroX(void)
 {
-	return readInt16_t(MPU6050_GYROX_DATA);
+	return readChannel(4);
 }
 
 int16_t SRL::MPU6050::getRawGyroY(void)
 {
-	return readInt16_t(MPU6050_GYROY_DATA);
+	return readChannel(5);
 }
 
 int16_t SRL::MPU6050::getRawGyroZ(void)
 {
-	return readInt16_t(MPU6050_GYROZ_DATA);
+	return readChannel(6);
 }
 
 int16_t SRL::MPU6050::getRawTemp(void)
 {
-	return readInt16_t(MPU6050_TEMP_DATA);
+	return readChannel(3);
 }
 
+/**
+*	Returns the die temperature of the MPU6050.
+*
+*	@return The temperature in Celsius.
+*/
 double SRL::MPU6050::getTemp(void)
 {
-	return (getRawTemp() + MPU6050_TEMP_BIAS) / MPU6050_TEMP_DIVISOR;
+	return convertTemp(getRawTemp());
+}
+
+/**
+*	Returns whether the values read since the previous call are fresh.
+*
+*	@return Returns 0 if every burst read since the previous call succeeded,
+*	1 if one failed and old values were returned instead.
+*/
+uint8_t SRL::MPU6050::getReadStatus(void)
+{
+	uint8_t status = readStatus;
+	readStatus = 0;
+
+	return status;
 }
@@ -27,6 +27,7 @@
 #include "SRL.h"
 #include "I2C.h"
 #include "AccelGyro.h"
+#include "Thermometer.h"
 #include "Component.h"
 
 #define MPU6050_COMPONENT_NAME "MPU6050"
@@ -48,6 +49,11 @@
 #define MPU6050_GYROY_DATA	 0x45
 #define MPU6050_GYROZ_DATA	 0x47
 
+#define MPU6050_BURST_DATA   0x3b
+#define MPU6050_BURST_LENGTH 14
+#define MPU6050_BURST_CHANNELS 7
+#define MPU6050_BURST_MAX_AGE 1000 // us, older bursts are read again, the accelerometer updates at 1 kHz
+
 #define MPU6050_GYRO_CONFIG_FS_SEL_BIT  4
 #define MPU6050_GYRO_CONFIG_FS_SEL_LENGTH 2
 
@@ -72,8 +78,14 @@ namespace SRL
 	/**
 	*	Class MPU6050. A class for communicating with the MPU6050 accelerometer
 	* and gyroscope.
+	*	The accelerometer, temperature and gyroscope registers are read together
+	*	in one burst. A burst is repeated when a value already returned from it
+	*	is asked for again or it is older than MPU6050_BURST_MAX_AGE, so the six
+	*	axes and the temperature of one sample cost a single transaction. If a
+	*	burst can not be read the previous values are returned and
+	*	getReadStatus() reports the failure.
 	*/
-	class MPU6050 : protected SRL::I2CDevice, public SRL::AccelGyro
+	class MPU6050 : protected SRL::I2CDevice, public SRL::AccelGyro, public SRL::Thermometer
 	{
 		public:
 			MPU6050(uint8_t address, float aC = 0.02f, float gC = 0.98f);
@@ -90,10 +102,21 @@ namespace SRL
 
 			int16_t getRawTemp(void);
 			double getTemp(void);
+			uint8_t getReadStatus(void);
 
 			/* Getters and setters */
 			uint8_t setAccelSensitivity(uint8_t setting);
 			uint8_t setGyroSensitivity(uint8_t setting);
+
+		private:
+			uint8_t readBurst(void);
+			int16_t readChannel(uint8_t channel);
+			double convertTemp(int16_t raw);
+
+			int16_t burst[MPU6050_BURST_CHANNELS];
+			unsigned long burstTime;
+			uint8_t consumed;
+			uint8_t readStatus;
 	};
 }
 
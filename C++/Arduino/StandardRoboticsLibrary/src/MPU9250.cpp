@@ -46,6 +46,7 @@ uint8_t SRL::MPU9250::initialize(void)
 	setGyroSensitivity(0);
 	
 	setAccelOffsets(0, 0, 0);
+	setAccelScales(ACCEL_UNITY_SCALE, ACCEL_UNITY_SCALE, ACCEL_UNITY_SCALE);
 	setGyroOffsets(0, 0, 0);
 
 	byte buff[1];
@@ -26,6 +26,11 @@
 
 #include "SRL.h"
 
+// On AVR the direction pins and the PWM compare register are written directly
+#if defined(__AVR__)
+#define MOTOR_FAST_IO
+#endif
+
 namespace SRL
 {
 	class Motor
@@ -43,6 +48,14 @@ namespace SRL
 		void forwards(void);
 		void backwards(void);
 
+		/* Coordinated updates */
+		void stageDirection(unsigned int state);
+		void stageSpeed(float speed);
+		void stageDuty(uint8_t duty);
+		void stageMoving(bool moving);
+		void commit(void);
+		static void commit(Motor* first, Motor* second);
+
 		/* Enums */
 		enum States
 		{
@@ -57,16 +70,38 @@ namespace SRL
 		float getSpeed(void);
 
 		void setSpeed(float speed);
+		void setDuty(uint8_t duty);
+		uint8_t getDuty(void);
 		unsigned int getDirection(void);
+		bool isMoving(void);
 
 	private:
+		void writePwm(void);
+		void writeOutput(void);
+		void writeDirection(void);
+
 		unsigned int forwardPin;
 		unsigned int backwardPin;
 		unsigned int pwmPin;
 
-		float speed;
+		uint8_t duty;
 		unsigned int direction;
 		bool moving;
+
+#ifdef MOTOR_FAST_IO
+		volatile uint8_t* forwardRegister;
+		volatile uint8_t* backwardRegister;
+		uint8_t forwardMask;
+		uint8_t backwardMask;
+
+		// Compare register of the PWM pin's timer, NULL if it has none
+		volatile uint8_t* pwmRegister8;
+		volatile uint16_t* pwmRegister16;
+		bool pwmConnected;
+
+		static void addPinWrite(volatile uint8_t** registers, uint8_t* clear, uint8_t* set, uint8_t* count,
+			volatile uint8_t* reg, uint8_t mask, bool high);
+#endif
 	};
 }
 #endif
@@ -31,3 +31,15 @@
 // to facilitate some crafty optimizations!
 
 Paul_Encoder_internal_state_t * Paul_Encoder::interruptArgs[];
+
+#ifdef ENCODER_USE_PIN_CHANGE
+bool Paul_Encoder::pinChangeVectors = false;
+Paul_Encoder_internal_state_t * Paul_Encoder::pinChangeArgs[ENCODER_PIN_CHANGE_GROUPS][ENCODER_PIN_CHANGE_MAX];
+volatile IO_REG_TYPE * Paul_Encoder::pinChangeInput[ENCODER_PIN_CHANGE_GROUPS];
+uint8_t Paul_Encoder::pinChangeCount[ENCODER_PIN_CHANGE_GROUPS];
+
+// Steps of a state change, indexed like the table above update()
+const int8_t Paul_Encoder::pinChangeSteps[16] = {
+	0, 1, -1, 2, -1, 0, -2, 1, 1, -2, 0, -1, 2, -1, 1, 0
+};
+#endif
@@ -47,6 +47,21 @@
 #ifdef ENCODER_OPTIMIZE_INTERRUPTS
 #include "interrupt_config.h"
 #endif
+// Pins without an external interrupt can be decoded from the pin change
+// interrupt of their port, one vector serves every encoder on the port.
+// The vectors clash with SoftwareSerial and other pin change users, so
+// they are only defined where ENCODER_PIN_CHANGE_INTERRUPTS is defined
+// before including this header, see the end of this file. Without them
+// such pins are polled.
+#if defined(__AVR__) && defined(PCICR) && defined(digitalPinToPCICR)
+#define ENCODER_USE_PIN_CHANGE
+#if defined(PCIE3)
+#define ENCODER_PIN_CHANGE_GROUPS 4
+#else
+#define ENCODER_PIN_CHANGE_GROUPS 3
+#endif
+#define ENCODER_PIN_CHANGE_MAX 4
+#endif
 #else
 #define ENCODER_ARGLIST_SIZE 0
 #endif
@@ -64,6 +79,10 @@ typedef struct {
 	IO_REG_TYPE            pin2_bitmask;
 	uint8_t                state;
 	int32_t                position;
+	// Edge timing for velocity estimation, not used by the assembly code
+	uint32_t               edge_time;
+	uint32_t               edge_period;
+	int8_t                 direction;
 } Paul_Encoder_internal_state_t;
 
 class Paul_Encoder
@@ -84,6 +103,9 @@ public:
 		encoder.pin2_register = PIN_TO_BASEREG(pin2);
 		encoder.pin2_bitmask = PIN_TO_BITMASK(pin2);
 		encoder.position = 0;
+		encoder.edge_time = 0;
+		encoder.edge_period = 0;
+		encoder.direction = 0;
 		// allow time for a passive R-C filter to charge
 		// through the pullup resistors, before reading
 		// the initial state
@@ -93,8 +115,13 @@ public:
 		if (DIRECT_PIN_READ(encoder.pin2_register, encoder.pin2_bitmask)) s |= 2;
 		encoder.state = s;
 #ifdef ENCODER_USE_INTERRUPTS
-		interrupts_in_use = attach_interrupt(pin1, &encoder);
-		interrupts_in_use += attach_interrupt(pin2, &encoder);
+		uint8_t attached1 = attach_interrupt(pin1, &encoder);
+		uint8_t attached2 = attach_interrupt(pin2, &encoder);
+#ifdef ENCODER_USE_PIN_CHANGE
+		if (!attached1) attached1 = attach_pin_change(pin1, &encoder);
+		if (!attached2) attached2 = attach_pin_change(pin2, &encoder);
+#endif
+		interrupts_in_use = attached1 + attached2;
 #endif
 		//update_finishup();  // to force linker to include the code (does not work)
 	}
@@ -112,20 +139,52 @@ public:
 		interrupts();
 		return ret;
 	}
-	inline void write(int32_t p) {
+	// Virtual, so subclasses keeping positions of their own see every write
+	virtual void write(int32_t p) {
 		noInterrupts();
 		encoder.position = p;
 		interrupts();
 	}
+	// Reads the position without enabling interrupts, so several
+	// encoders can be read inside one critical section
+	inline int32_t peek() {
+		if (interrupts_in_use < 2) update(&encoder);
+		return encoder.position;
+	}
+	// Copies the position and the timing of the last edge at once
+	inline void readEdges(int32_t *p, uint32_t *time, uint32_t *period, int8_t *dir) {
+		noInterrupts();
+		if (interrupts_in_use < 2) update(&encoder);
+		*p = encoder.position;
+		*time = encoder.edge_time;
+		*period = encoder.edge_period;
+		*dir = encoder.direction;
+		interrupts();
+	}
 #else
 	inline int32_t read() {
 		update(&encoder);
 		return encoder.position;
 	}
-	inline void write(int32_t p) {
+	virtual void write(int32_t p) {
 		encoder.position = p;
 	}
+	inline int32_t peek() {
+		update(&encoder);
+		return encoder.position;
+	}
+	inline void readEdges(int32_t *p, uint32_t *time, uint32_t *period, int8_t *dir) {
+		update(&encoder);
+		*p = encoder.position;
+		*time = encoder.edge_time;
+		*period = encoder.edge_period;
+		*dir = encoder.direction;
+	}
 #endif
+	// Sets the position without enabling interrupts, like peek()
+	inline void poke(int32_t p) {
+		encoder.position = p;
+	}
 private:
 	Paul_Encoder_internal_state_t encoder;
 #ifdef ENCODER_USE_INTERRUPTS
@@ -133,6 +192,13 @@ private:
 #endif
 public:
 	static Paul_Encoder_internal_state_t * interruptArgs[ENCODER_ARGLIST_SIZE];
+#ifdef ENCODER_USE_PIN_CHANGE
+	static bool pinChangeVectors;
+	static Paul_Encoder_internal_state_t * pinChangeArgs[ENCODER_PIN_CHANGE_GROUPS][ENCODER_PIN_CHANGE_MAX];
+	static volatile IO_REG_TYPE * pinChangeInput[ENCODER_PIN_CHANGE_GROUPS];
+	static uint8_t pinChangeCount[ENCODER_PIN_CHANGE_GROUPS];
+	static const int8_t pinChangeSteps[16];
+#endif
 
 //                           _______         _______
 //               Pin1 ______|       |_______|       |______ Pin1
@@ -187,6 +253,7 @@ public:
 	// DO NOT call update() directly from sketches.
 	static void update(Paul_Encoder_internal_state_t *arg) {
 #if defined(__AVR__)
+		int32_t before = arg->position;
 		// The compiler believes this is just 1 line of code, so
 		// it will inline this function into each interrupt
 		// handler.  That's a tiny bit faster, but grows the code.
@@ -269,7 +336,10 @@ public:
 			"st	-X, r23"		"\n\t"
 			"st	-X, r22"		"\n\t"
 		"L%=end:"				"\n"
-		: : "x" (arg) : "r22", "r23", "r24", "r25", "r30", "r31");
+		: : "x" (arg) : "r22", "r23", "r24", "r25", "r30", "r31", "memory");
+		if (arg->position != before) {
+			edge(arg, arg->position > before ? 1 : -1);
+		}
 #else
 		uint8_t p1val = DIRECT_PIN_READ(arg->pin1_register, arg->pin1_bitmask);
 		uint8_t p2val = DIRECT_PIN_READ(arg->pin2_register, arg->pin2_bitmask);
@@ -280,19 +350,52 @@ public:
 		switch (state) {
 			case 1: case 7: case 8: case 14:
 				arg->position++;
+				edge(arg, 1);
 				return;
 			case 2: case 4: case 11: case 13:
 				arg->position--;
+				edge(arg, -1);
 				return;
 			case 3: case 12:
 				arg->position += 2;
+				edge(arg, 1);
 				return;
 			case 6: case 9:
 				arg->position -= 2;
+				edge(arg, -1);
 				return;
 		}
 #endif
 	}
+#ifdef ENCODER_USE_PIN_CHANGE
+	// Updates every encoder of a pin change group from a single read of
+	// the port, with the same state table as update(). Pins on another
+	// port (possible when a group spans ports) are read separately.
+	// Called from the group's interrupt vector, DO NOT call from sketches.
+	static void pin_change(uint8_t group) {
+		volatile IO_REG_TYPE *port = pinChangeInput[group];
+		IO_REG_TYPE in = *port;
+		for (uint8_t i = 0; i < pinChangeCount[group]; i++) {
+			Paul_Encoder_internal_state_t *arg = pinChangeArgs[group][i];
+			uint8_t state = arg->state & 3;
+			if (((arg->pin1_register == port) ? in : *arg->pin1_register) & arg->pin1_bitmask) state |= 4;
+			if (((arg->pin2_register == port) ? in : *arg->pin2_register) & arg->pin2_bitmask) state |= 8;
+			arg->state = (state >> 2);
+			int8_t step = pinChangeSteps[state];
+			if (step != 0) {
+				arg->position += step;
+				edge(arg, (step > 0) ? 1 : -1);
+			}
+		}
+	}
+#endif
+	// Records the time of a counted edge and the time since the previous one
+	static inline void edge(Paul_Encoder_internal_state_t *arg, int8_t dir) {
+		uint32_t now = micros();
+		arg->edge_period = (dir == arg->direction) ? now - arg->edge_time : 0;
+		arg->edge_time = now;
+		arg->direction = dir;
+	}
 private:
 /*
 #if defined(__AVR__)
@@ -354,6 +457,35 @@ private:
 */
 
 
+#ifdef ENCODER_USE_PIN_CHANGE
+	// Adds an encoder to the pin change group of a pin and enables the
+	// pin's change interrupt. Returns 1 if the pin has one, 0 otherwise
+	// or if the vectors are not defined.
+	static uint8_t attach_pin_change(uint8_t pin, Paul_Encoder_internal_state_t *state) {
+		if (!pinChangeVectors) return 0;
+		volatile uint8_t *pcicr = digitalPinToPCICR(pin);
+		if (pcicr == 0) return 0;
+		uint8_t group = digitalPinToPCICRbit(pin);
+		if (group >= ENCODER_PIN_CHANGE_GROUPS) return 0;
+		noInterrupts();
+		uint8_t i = 0;
+		while (i < pinChangeCount[group] && pinChangeArgs[group][i] != state) i++;
+		if (i == pinChangeCount[group]) {
+			if (i >= ENCODER_PIN_CHANGE_MAX) {
+				interrupts();
+				return 0;
+			}
+			if (i == 0) pinChangeInput[group] = portInputRegister(digitalPinToPort(pin));
+			pinChangeArgs[group][i] = state;
+			pinChangeCount[group]++;
+		}
+		*digitalPinToPCMSK(pin) |= _BV(digitalPinToPCMSKbit(pin));
+		*pcicr |= _BV(group);
+		interrupts();
+		return 1;
+	}
+#endif
+
 #ifdef ENCODER_USE_INTERRUPTS
 	// this giant function is an unfortunate consequence of Arduino's
 	// attachInterrupt function not supporting any way to pass a pointer
@@ -948,4 +1080,21 @@ ISR(INT7_vect) { Paul_Encoder::update(Paul_Encoder::interruptArgs[SCRAMBLE_INT_O
 #endif // ENCODER_OPTIMIZE_INTERRUPTS
 
 
+#if defined(ENCODER_USE_PIN_CHANGE) && defined(ENCODER_PIN_CHANGE_INTERRUPTS)
+#ifdef PCINT0_vect
+ISR(PCINT0_vect) { Paul_Encoder::pin_change(0); }
+#endif
+#ifdef PCINT1_vect
+ISR(PCINT1_vect) { Paul_Encoder::pin_change(1); }
+#endif
+#ifdef PCINT2_vect
+ISR(PCINT2_vect) { Paul_Encoder::pin_change(2); }
+#endif
+#if defined(PCINT3_vect) && ENCODER_PIN_CHANGE_GROUPS > 3
+ISR(PCINT3_vect) { Paul_Encoder::pin_change(3); }
+#endif
+// Initialized before the encoders declared after the #include, so they attach to the vectors
+static bool Paul_Encoder_pin_change_vectors = (Paul_Encoder::pinChangeVectors = true);
+#endif // ENCODER_PIN_CHANGE_INTERRUPTS
+
 #endif
@@ -23,15 +23,36 @@
 */
 #include "Rover.h"
 
-SRL::Rover::Rover(SRL::Motor* leftMotor, SRL::Motor* rightMotor, double x, double y, float direction): Tank(leftMotor, rightMotor)
+SRL::Rover::Rover(SRL::Motor* leftMotor, SRL::Motor* rightMotor, double x, double y, float direction): Tank(leftMotor, rightMotor),
+	leftSpeed(leftMotor), rightSpeed(rightMotor),
+	profile(ROVER_DEFAULT_CRUISE_SPEED, ROVER_DEFAULT_ACCELERATION, ROVER_DEFAULT_JERK)
 {
 	this->x = x;
 	this->y = y;
 	this->direction = SRL::Angle(direction);
+	trackWidth = ROVER_DEFAULT_TRACK_WIDTH;
+	leftStart = rightStart = 0;
+	turnRemaining = 0.0f;
+	turnRate = 0.0f;
+	turnSpeed = 0.0;
+	leftHeading = rightHeading = 0;
+	driveVelocity = driveCurvature = driveSpeed = 0.0;
+	driveRate = 0.0f;
+	waypointHead = waypointCount = 0;
+	waypointsReached = 0;
+	pathX = pathY = pathLength = 0.0;
+	slipCount = 0;
+	slipTime = 0;
+	slipVelocity = encoderVelocity = accelBias = 0.0;
+	standingSince = gyroBiasTime = 0;
 }
 
 SRL::Rover::~Rover(void)
 {
+	SRL::Executive::remove(correctMotorsTask, this);
+	SRL::Executive::remove(controlHeadingTask, this);
+	SRL::Executive::remove(updatePositionTask, this);
+
 	delete leftMotor;
 	delete rightMotor;
 	delete leftEncoder;
@@ -40,8 +61,9 @@ SRL::Rover::~Rover(void)
 }
 
 /**
-*	Initialize the rover.
-*
+*	Initialize the rover. Registers correctMotors(), controlHeading() and
+*	updatePosition() with the executive at their intervals, so the sketch
+*	does not have to call them once it started the executive.
 */
 void SRL::Rover::initialize(void)
 {
@@ -53,151 +75,816 @@ void SRL::Rover::initialize(void)
 
 	if (accelGyro != NULL)
 		accelGyro->initialize();
+
+	if (leftEncoder != NULL && rightEncoder != NULL)
+	{
+		leftHeading = leftEncoder->read();
+		rightHeading = rightEncoder->read();
+	}
+
+	SRL::Executive::add(correctMotorsTask, this, CORRECT_MOTORS_INTERVAL, ROVER_CORRECT_MOTORS_PRIORITY);
+	SRL::Executive::add(controlHeadingTask, this, CONTROL_HEADING_INTERVAL, ROVER_CONTROL_HEADING_PRIORITY);
+	SRL::Executive::add(updatePositionTask, this, UPDATE_POSITION_INTERVAL, ROVER_UPDATE_POSITION_PRIORITY);
 }
 
+/**
+*	Drives the rover to a point. Instead of turning first and then driving
+*	straight, the rover arcs towards the point and corrects its heading while
+*	it drives. It only turns in place while the point is more than
+*	ROVER_PIVOT_ANGLE off its heading. Waypoints queued before are dropped.
+*
+*	@param x The x coordinate of the point in cm.
+*	@param y The y coordinate of the point in cm.
+*/
 void SRL::Rover::goTo(double x, double y)
 {
-	SRL::Vector v = Vector(x - this->x, y - this->y);
-	turnTo(v.getAngle());
-	forward(v.getLength());
+	drive(0.0);
+	addWaypoint(x, y);
 }
 
+/**
+*	Adds a waypoint to the end of the rover's path. The rover starts driving
+*	along the path if it is not following one yet, from where it is. The
+*	call returns at once, the path is followed by the executive's tasks.
+*
+*	@param x The x coordinate of the waypoint in cm.
+*	@param y The y coordinate of the waypoint in cm.
+*	@return
+*	Returns 0 if successful, 1 if ROVER_MAX_WAYPOINTS are queued already.
+*/
+uint8_t SRL::Rover::addWaypoint(double x, double y)
+{
+	bool starting = !seeking;
+
+	if (starting)
+	{
+		drive(0.0);
+	}
+
+	SRL_ATOMIC_BEGIN();
+
+	if (starting)
+	{
+		pathX = this->x;
+		pathY = this->y;
+		pathLength = 0.0;
+		waypointsReached = 0;
+	}
+
+	if (waypointCount >= ROVER_MAX_WAYPOINTS)
+	{
+		SRL_ATOMIC_END();
+		return 1;
+	}
+
+	if (waypointCount > 0)
+	{
+		uint8_t last = (waypointHead + waypointCount - 1) % ROVER_MAX_WAYPOINTS;
+		double dx = x - waypointX[last];
+		double dy = y - waypointY[last];
+		pathLength += sqrt(dx * dx + dy * dy);
+	}
+
+	uint8_t index = (waypointHead + waypointCount) % ROVER_MAX_WAYPOINTS;
+	waypointX[index] = x;
+	waypointY[index] = y;
+	waypointCount++;
+	seeking = true;
+
+	SRL_ATOMIC_END();
+	return 0;
+}
+
+/**
+*	Drops the waypoints, the rover stops.
+*/
+void SRL::Rover::clearWaypoints(void)
+{
+	SRL_ATOMIC_BEGIN();
+	waypointCount = 0;
+	SRL_ATOMIC_END();
+
+	if (seeking)
+	{
+		stop();
+	}
+}
+
+/**
+*	Returns the number of waypoints the rover has not reached yet.
+*/
+uint8_t SRL::Rover::getWaypointCount(void)
+{
+	return waypointCount;
+}
+
+/**
+*	Returns the number of waypoints reached since the rover started
+*	following its path.
+*/
+unsigned int SRL::Rover::getWaypointsReached(void)
+{
+	SRL_ATOMIC_BEGIN();
+	unsigned int reached = waypointsReached;
+	SRL_ATOMIC_END();
+
+	return reached;
+}
+
+/**
+*	Returns the length of the path left to the last waypoint in cm.
+*/
+double SRL::Rover::getRemainingDistance(void)
+{
+	SRL_ATOMIC_BEGIN();
+
+	double remaining = 0.0;
+
+	if (waypointCount > 0)
+	{
+		double dx = waypointX[waypointHead] - x;
+		double dy = waypointY[waypointHead] - y;
+		remaining = sqrt(dx * dx + dy * dy) + pathLength;
+	}
+
+	SRL_ATOMIC_END();
+	return remaining;
+}
+
+/**
+*	Returns whether the rover executes a movement command.
+*/
+bool SRL::Rover::isMoving(void)
+{
+	return movingStraight || turning || driving;
+}
+
+/**
+*	Drives the rover along an arc until another movement command or stop().
+*	The speed ramps to the new velocity with the motion profile's
+*	acceleration. A command given while the rover moves takes over without
+*	stopping it.
+*
+*	@param velocity The speed of the rover's center in cm/s, negative is backwards.
+*	@param curvature One over the radius of the arc in 1/cm, positive to the right.
+*/
+void SRL::Rover::drive(double velocity, double curvature)
+{
+	if (!isMoving())
+	{
+		startMotion(0.0);
+	}
+
+	SRL_ATOMIC_BEGIN();
+
+	bool starting = !driving;
+
+	if (starting)
+	{
+		// Continue from the speed of a straight move, start from rest otherwise
+		double speed = 0.0;
+
+		if (movingStraight)
+		{
+			speed = (Tank::getDirection() == Tank::BACKWARD) ? -profile.getVelocity() : profile.getVelocity();
+		}
+
+		movingStraight = false;
+		turning = false;
+		driveSpeed = speed;
+	}
+
+	driveVelocity = velocity;
+	driveCurvature = curvature;
+	driveRate = 0.0f;
+	turnRate = 0.0f;
+	seeking = false;
+	waypointCount = 0;
+	driving = true;
+
+	SRL_ATOMIC_END();
+
+	if (starting)
+	{
+		Tank::start();
+	}
+}
+
+/**
+*	Turns the rover to face a direction, along the shorter arc.
+*
+*	@param dir The direction to face.
+*/
 void SRL::Rover::turnTo(SRL::Angle dir)
 {
-	if (dir.getSize() > direction.getSize())
+	// Difference in the range of -180 to 180 degrees
+	float difference = fmod(dir.getSize() - getDirection() + 540.0f, 360.0f) - 180.0f;
+
+	if (difference > 0.0f)
 	{
-		// Turn right
-		turnRight(dir.getSize() - direction.getSize());
+		turnRight(difference);
 	}
-	else if (dir.getSize() != direction.getSize())
+	else if (difference < 0.0f)
 	{
-		// Turn left
-		turnLeft(direction.getSize() - dir.getSize());
+		turnLeft(-difference);
 	}
 }
 
 void SRL::Rover::forward(double distance)
 {
+	startMotion(distance);
+
 	// Calculate target position
-	SRL::Vector g = Vector(direction, distance);
-	xGoal = g.getX() + x;
-	yGoal = g.getY() + y;
+	SRL::Vector g = Vector(SRL::Angle(getDirection()), distance);
+	double goalX = g.getX() + getX();
+	double goalY = g.getY() + getY();
 
 	// Command movement
 	Tank::forwards();
 	Tank::start();
+
+	SRL_ATOMIC_BEGIN();
+	xGoal = goalX;
+	yGoal = goalY;
 	movingStraight = true;
+	SRL_ATOMIC_END();
 }
 
 void SRL::Rover::backward(double distance)
 {
+	startMotion(distance);
+
 	// Calculate target position
-	SRL::Vector g = Vector(direction, distance * -1);
-	xGoal = g.getX() + x;
-	yGoal = g.getY() + y;
+	SRL::Vector g = Vector(SRL::Angle(getDirection()), distance * -1);
+	double goalX = g.getX() + getX();
+	double goalY = g.getY() + getY();
 
 	// Command movement
 	Tank::backwards();
 	Tank::start();
+
+	SRL_ATOMIC_BEGIN();
+	xGoal = goalX;
+	yGoal = goalY;
 	movingStraight = true;
+	SRL_ATOMIC_END();
 }
 
 void SRL::Rover::turnRight(double amount)
 {
-	// Calculate target direction
-	turnGoal =  SRL::Angle(direction.getSize() + amount);
-
-	// Command movement
-	Tank::faceRight();
-	Tank::start();
-	turning = true;
+	startTurn(amount);
 }
 
 void SRL::Rover::turnLeft(double amount)
 {
-	// Calculate target direction
-	turnGoal =  SRL::Angle(direction.getSize() + amount * -1);
-
-	// Command movement
-	Tank::faceLeft();
-	Tank::start();
-	turning = true;
+	startTurn(amount * -1);
 }
 
+/**
+*	Stops the rover. Also called by the executive's tasks when a command ends.
+*/
 void SRL::Rover::stop(void)
 {
+	SRL_ATOMIC_BEGIN();
+
+	movingStraight = false;
+	turning = false;
+
+	leftSpeed.setTarget(0);
+	rightSpeed.setTarget(0);
+	turnRate = 0.0f;
+	turnSpeed = 0.0;
+
+	driving = false;
+	seeking = false;
+	waypointCount = 0;
+	driveVelocity = driveCurvature = driveSpeed = 0.0;
+	driveRate = 0.0f;
+
+	SRL_ATOMIC_END();
+
 	Tank::stop();
+}
+
+/**
+*	Prepares a move, which replaces any other move, turn, arc or path. The
+*	executive's tasks are stopped from running the previous command first,
+*	so the wheels' start positions, the speed controllers and the motion
+*	profile are set up while no task reads them. The caller then sets up
+*	the motors and publishes its command's flag with SRL_ATOMIC_BEGIN().
+*
+*	@param distance The distance each wheel travels in cm.
+*/
+void SRL::Rover::startMotion(double distance)
+{
+	SRL_ATOMIC_BEGIN();
 	movingStraight = false;
 	turning = false;
+	turnRate = 0.0f;
+	turnSpeed = 0.0;
+	driving = false;
+	seeking = false;
+	waypointCount = 0;
+	SRL_ATOMIC_END();
+
+	if (leftEncoder != NULL && rightEncoder != NULL)
+	{
+		SRL::Encoder* encoders[2] = { leftEncoder, rightEncoder };
+		long positions[2];
+		SRL::Encoder::snapshot(encoders, positions, 2);
+
+		leftStart = positions[0];
+		rightStart = positions[1];
+	}
+
+	leftSpeed.reset();
+	rightSpeed.reset();
+	profile.start(fabs(distance));
+}
+
+/**
+*	Starts turning the rover in place. The turn is steered by controlHeading().
+*
+*	@param amount The angle to turn in degrees, positive to the right.
+*/
+void SRL::Rover::startTurn(double amount)
+{
+	startMotion(0.0);
+
+	if (amount >= 0)
+	{
+		Tank::faceRight();
+	}
+	else
+	{
+		Tank::faceLeft();
+	}
+
+	Tank::start();
+
+	SRL_ATOMIC_BEGIN();
+	turnRemaining = amount;
+	turning = true;
+	SRL_ATOMIC_END();
 }
 
 /**
 *	An interrupt routine to correct the rover's motors.
+*	Both wheels follow the velocity of the move's motion profile, or of the
+*	turn commanded by controlHeading(), with their speed controllers. The
+*	wheel that got ahead since the movement started is slowed down and the
+*	other sped up, so the rover keeps its heading instead of weaving. A move
+*	ends with the profile.
 */
 void SRL::Rover::correctMotors(void)
 {
-	if (movingStraight)
+	if ((!movingStraight && !turning && !driving) || leftEncoder == NULL || rightEncoder == NULL)
+	{
+		return;
+	}
+
+	if (driving)
+	{
+		driveMotors();
+		return;
+	}
+
+	double speed;
+
+	if (turning)
+	{
+		SRL_ATOMIC_BEGIN();
+		speed = turnSpeed;
+		SRL_ATOMIC_END();
+	}
+	else
+	{
+		speed = profile.update(CORRECT_MOTORS_INTERVAL / 1000000.0);
+
+		if (profile.isFinished())
+		{
+			stop();
+			return;
+		}
+	}
+
+	unsigned int state = Tank::getDirection();
+	int leftSign = (state == Tank::FORWARD || state == Tank::RIGHT) ? 1 : -1;
+	int rightSign = (state == Tank::FORWARD || state == Tank::LEFT) ? 1 : -1;
+
+	// Progress of each wheel along its commanded direction
+	SRL::Encoder* encoders[2] = { leftEncoder, rightEncoder };
+	long positions[2];
+	SRL::Encoder::snapshot(encoders, positions, 2);
+
+	long left = (positions[0] - leftStart) * leftSign * (leftSpeed.getReversed() ? -1 : 1);
+	long right = (positions[1] - rightStart) * rightSign * (rightSpeed.getReversed() ? -1 : 1);
+
+	long cruise = leftEncoder->convertSteps(speed);
+	long leftTarget = cruise - ROVER_SYNC_GAIN * (left - right);
+	long rightTarget = cruise + ROVER_SYNC_GAIN * (left - right);
+
+	setTargets(leftSign * ((leftTarget > 0) ? leftTarget : 0), rightSign * ((rightTarget > 0) ? rightTarget : 0));
+}
+
+/**
+*	Sets the speed controllers' targets of an arc. The speed of the rover's
+*	center ramps to the commanded velocity, the wheels' speeds differ by the
+*	turn rate of the arc at that speed plus the commanded turn rate.
+*/
+void SRL::Rover::driveMotors(void)
+{
+	SRL_ATOMIC_BEGIN();
+	double velocity = driveVelocity;
+	double curvature = driveCurvature;
+	float rate = driveRate;
+	SRL_ATOMIC_END();
+
+	double change = profile.getMaxAcceleration() * CORRECT_MOTORS_INTERVAL / 1000000.0;
+
+	if (driveSpeed < velocity - change)
+	{
+		driveSpeed += change;
+	}
+	else if (driveSpeed > velocity + change)
+	{
+		driveSpeed -= change;
+	}
+	else
 	{
-		long l = leftEncoder->read();
-		long r = rightEncoder->read();
+		driveSpeed = velocity;
+	}
+
+	// Half the speed difference of the wheels, in cm/s
+	double turn = (curvature * driveSpeed + rate * PI / 180) * trackWidth / 2;
+
+	setTargets(leftEncoder->convertSteps(driveSpeed + turn), rightEncoder->convertSteps(driveSpeed - turn));
+}
 
-		if (Tank::getDirection() == Tank::FORWARD)
+/**
+*	Sets the speed controllers' targets and updates them. Both motors are
+*	written by one Motor::commit(), so the wheels never run on one new and
+*	one old output. While the wheels slip with traction control on, the
+*	speed they share is cut to the estimated velocity plus half of
+*	ROVER_SLIP_VELOCITY, so they grip again. The difference of their speeds,
+*	which turns the rover, is kept.
+*
+*	@param left The left wheel's speed in steps/s.
+*	@param right The right wheel's speed in steps/s.
+*/
+void SRL::Rover::setTargets(long left, long right)
+{
+	if (slipping && tractionControl)
+	{
+		long limit = leftEncoder->convertSteps(fabs(slipVelocity) + ROVER_SLIP_VELOCITY / 2);
+		long common = (left + right) / 2;
+		long turn = (left - right) / 2;
+
+		if (common > limit)
 		{
-			if (l > r)
-			{
-				leftMotor->setSpeed(getCorrectionSpeed(abs(l-r)));
-				rightMotor->setSpeed(100);
-			}
-			else if (l != r)
-			{
-				rightMotor->setSpeed(getCorrectionSpeed(abs(r-l)));
-				leftMotor->setSpeed(100);
-			}
-			else
-			{
-				setUnifiedSpeed(100);
-			}
+			common = limit;
 		}
-		else
+		else if (common < -limit)
 		{
-			if (l < r)
-			{
-				leftMotor->setSpeed(getCorrectionSpeed(abs(l-r)));
-				rightMotor->setSpeed(100);
-			}
-			else if (l != r)
-			{
-				rightMotor->setSpeed(getCorrectionSpeed(abs(r-l)));
-				leftMotor->setSpeed(100);
-			}
-			else
-			{
-				leftMotor->setSpeed(100);
-				rightMotor->setSpeed(100);
-			}
+			common = -limit;
 		}
+
+		left = common + turn;
+		right = common - turn;
 	}
+
+	leftSpeed.setTarget(left);
+	rightSpeed.setTarget(right);
+	leftSpeed.stage();
+	rightSpeed.stage();
+	Motor::commit(leftMotor, rightMotor);
 }
 
 /**
-*	An interrupt routine to update the rover's virtual position.
+*	An interrupt routine to track the rover's heading and steer its turns.
+*	The heading follows the gyroscope's yaw rate while the AccelGyro's
+*	samples are fresh, and the encoders' differential otherwise, e.g. when
+*	the sketch does not sample the AccelGyro. Turns run at the highest rate
+*	they can still stop from at the goal, and the difference between the
+*	commanded and the measured rate corrects the wheel speed. A turn that
+*	overshoots reverses, and ends within ROVER_TURN_TOLERANCE of its goal.
+*	goTo() is steered from here as well.
+*/
+void SRL::Rover::controlHeading(void)
+{
+	if (leftEncoder == NULL || rightEncoder == NULL)
+	{
+		return;
+	}
+
+	const float dt = CONTROL_HEADING_INTERVAL / 1000000.0f;
+
+	/* Measure the turn rate, clockwise positive */
+	SRL::Encoder* encoders[2] = { leftEncoder, rightEncoder };
+	long positions[2];
+	SRL::Encoder::snapshot(encoders, positions, 2);
+
+	long leftSteps = positions[0] - leftHeading;
+	long rightSteps = positions[1] - rightHeading;
+	leftHeading = positions[0];
+	rightHeading = positions[1];
+
+	// Keep tracking while the rover coasts after a move, not while it stands
+	if (!movingStraight && !turning && !driving && leftSteps == 0 && rightSteps == 0)
+	{
+		return;
+	}
+
+	double left = leftEncoder->convertCm(leftSteps * (leftSpeed.getReversed() ? -1 : 1));
+	double right = rightEncoder->convertCm(rightSteps * (rightSpeed.getReversed() ? -1 : 1));
+
+	float rate = (left - right) / trackWidth * 180 / PI / dt;
+
+	if (accelGyro != NULL)
+	{
+		// Wheels slip when turning in place, the gyroscope does not
+		SRL::Sample<SRL::Axes> gyro = accelGyro->getGyroSample();
+
+		if (gyro.timestamp != 0 && gyro.getAge(micros()) < ROVER_GYRO_TIMEOUT)
+		{
+			rate = -gyro.value.z;
+		}
+	}
+
+	float change = rate * dt;
+	direction.setAngle(direction.getSize() + change);
+
+	if (seeking)
+	{
+		seekGoal(rate);
+		return;
+	}
+
+	if (!turning)
+	{
+		return;
+	}
+
+	/* Steer the turn */
+	turnRemaining -= change;
+
+	if (fabs(turnRemaining) < ROVER_TURN_TOLERANCE)
+	{
+		stop();
+		return;
+	}
+
+	if (turnRemaining > 0 && Tank::getDirection() != Tank::RIGHT)
+	{
+		Tank::faceRight();
+		turnRate = 0.0f;
+	}
+	else if (turnRemaining < 0 && Tank::getDirection() != Tank::LEFT)
+	{
+		Tank::faceLeft();
+		turnRate = 0.0f;
+	}
+
+	float radius = trackWidth / 2;
+	float maxRate = profile.getMaxVelocity() / radius * 180 / PI;
+	float maxAcceleration = profile.getMaxAcceleration() / radius * 180 / PI;
+
+	// Accelerate up to the highest rate the rover can still stop from at the goal
+	float target = turnRate + maxAcceleration * dt;
+	float stopping = sqrt(2 * maxAcceleration * fabs(turnRemaining));
+
+	if (target > maxRate)
+	{
+		target = maxRate;
+	}
+
+	if (target > stopping)
+	{
+		target = stopping;
+	}
+
+	turnRate = target;
+
+	float measured = (turnRemaining > 0) ? rate : -rate;
+	float command = target + ROVER_TURN_RATE_GAIN * (target - measured);
+	command = (command > 0) ? command : 0;
+
+	double speed = command * PI / 180 * radius;
+	SRL_ATOMIC_BEGIN();
+	turnSpeed = speed;
+	SRL_ATOMIC_END();
+}
+
+/**
+*	Steers the rover along its waypoints with pure pursuit: the rover follows
+*	the arc tangent to its heading through the point ROVER_LOOKAHEAD ahead
+*	of it on the path. Intermediate waypoints are passed through without
+*	slowing down more than the arcs require, the speed is the highest one
+*	the rover can still stop from at the last waypoint. While the steered
+*	point is more than ROVER_PIVOT_ANGLE off the heading, the rover turns in
+*	place towards it instead.
+*
+*	@param rate The measured turn rate in deg/s, clockwise positive.
+*/
+void SRL::Rover::seekGoal(float rate)
+{
+	if (waypointCount == 0)
+	{
+		stop();
+		return;
+	}
+
+	double wx = waypointX[waypointHead];
+	double wy = waypointY[waypointHead];
+	double distance = sqrt((wx - x) * (wx - x) + (wy - y) * (wy - y));
+
+	// Direction and length of the segment leading to the waypoint
+	double sx = wx - pathX;
+	double sy = wy - pathY;
+	double segment = sqrt(sx * sx + sy * sy);
+	double along = segment;
+
+	if (segment > 0.0)
+	{
+		sx /= segment;
+		sy /= segment;
+		along = (x - pathX) * sx + (y - pathY) * sy;
+	}
+
+	if (waypointCount > 1 && (distance < ROVER_LOOKAHEAD || along >= segment))
+	{
+		nextWaypoint();
+		return;
+	}
+
+	if (waypointCount == 1 && distance < ROVER_GOAL_TOLERANCE)
+	{
+		nextWaypoint();
+		stop();
+		return;
+	}
+
+	/* Find the point to steer towards */
+	double gx = wx;
+	double gy = wy;
+	double ahead = ((along > 0.0) ? along : 0.0) + ROVER_LOOKAHEAD;
+
+	if (ahead < segment)
+	{
+		gx = pathX + sx * ahead;
+		gy = pathY + sy * ahead;
+	}
+	else if (waypointCount > 1)
+	{
+		// Continue on the next segment
+		uint8_t next = (waypointHead + 1) % ROVER_MAX_WAYPOINTS;
+		double nx = waypointX[next] - wx;
+		double ny = waypointY[next] - wy;
+		double length = sqrt(nx * nx + ny * ny);
+		double beyond = ahead - segment;
+
+		if (length > 0.0)
+		{
+			beyond = (beyond < length) ? beyond : length;
+			gx = wx + nx / length * beyond;
+			gy = wy + ny / length * beyond;
+		}
+	}
+
+	double dx = gx - x;
+	double dy = gy - y;
+	double lookahead = sqrt(dx * dx + dy * dy);
+
+	// Bearing of the point relative to the heading, in the range of -180 to 180 degrees
+	float error = fmod(atan2(dx, dy) * 180 / PI - direction.getSize() + 540.0, 360.0) - 180.0f;
+
+	const float dt = CONTROL_HEADING_INTERVAL / 1000000.0f;
+	float radius = trackWidth / 2;
+	double velocity = sqrt(2 * profile.getMaxAcceleration() * (distance + pathLength));
+	double curvature = 0.0;
+	float turn = 0.0f;
+
+	if (velocity > profile.getMaxVelocity())
+	{
+		velocity = profile.getMaxVelocity();
+	}
+
+	if (fabs(error) > ROVER_PIVOT_ANGLE)
+	{
+		float maxRate = profile.getMaxVelocity() / radius * 180 / PI;
+		float maxAcceleration = profile.getMaxAcceleration() / radius * 180 / PI;
+
+		turnRate += maxAcceleration * dt;
+
+		if (turnRate > maxRate)
+		{
+			turnRate = maxRate;
+		}
+
+		float measured = (error > 0) ? rate : -rate;
+		float command = turnRate + ROVER_TURN_RATE_GAIN * (turnRate - measured);
+		command = (command > 0) ? command : 0;
+
+		velocity = 0.0;
+		turn = (error > 0) ? command : -command;
+	}
+	else
+	{
+		turnRate = 0.0f;
+		velocity *= cos(error * PI / 180);
+		curvature = 2 * sin(error * PI / 180) / lookahead;
+
+		// Keep the centripetal acceleration within the profile's acceleration
+		double centripetal = (curvature != 0.0) ? sqrt(profile.getMaxAcceleration() / fabs(curvature)) : velocity;
+
+		if (velocity > centripetal)
+		{
+			velocity = centripetal;
+		}
+	}
+
+	SRL_ATOMIC_BEGIN();
+	driveVelocity = velocity;
+	driveCurvature = curvature;
+	driveRate = turn;
+	SRL_ATOMIC_END();
+}
+
+/**
+*	Drops the current waypoint, the path continues from it to the next one.
+*/
+void SRL::Rover::nextWaypoint(void)
+{
+	SRL_ATOMIC_BEGIN();
+
+	pathX = waypointX[waypointHead];
+	pathY = waypointY[waypointHead];
+	waypointHead = (waypointHead + 1) % ROVER_MAX_WAYPOINTS;
+	waypointCount--;
+	waypointsReached++;
+
+	if (waypointCount > 0)
+	{
+		double dx = waypointX[waypointHead] - pathX;
+		double dy = waypointY[waypointHead] - pathY;
+		pathLength -= sqrt(dx * dx + dy * dy);
+	}
+
+	if (waypointCount <= 1 || pathLength < 0.0)
+	{
+		pathLength = 0.0;
+	}
+
+	SRL_ATOMIC_END();
+}
+
+/**
+*	An interrupt routine to update the rover's virtual position. The encoders'
+*	distance is weighted down while the wheels slip.
 */
 void SRL::Rover::updatePosition(void)
 {
+	if (leftEncoder == NULL || rightEncoder == NULL)
+	{
+		return;
+	}
+
 	/* Get traveled distance */
-	double le = leftEncoder->readCm();
-	double re = rightEncoder->readCm();
+	SRL::Encoder* encoders[2] = { leftEncoder, rightEncoder };
+	long steps[2];
+	SRL::Encoder::consumeAll(encoders, steps, 2);
+
+	// The wheels stand still without a command, learnGyroBias() may run
+	if (steps[0] == 0 && steps[1] == 0 && !isMoving())
+	{
+		if (!standing)
+		{
+			standingSince = micros();
+			standing = true;
+		}
+	}
+	else
+	{
+		standing = false;
+	}
+
+	double le = leftEncoder->convertCm(steps[0]);
+	double re = rightEncoder->convertCm(steps[1]);
 	double d = (le + re) / 2.0;
 
-	leftEncoder->write(0);
-	rightEncoder->write(0);
+	if (accelGyro != NULL)
+	{
+		d = detectSlip(le, re);
+	}
 
-	/* Get direction */
+	/* Combine data with current position, the direction is tracked by controlHeading() */
+	SRL::Vector v = Vector(direction, d);
 
-	/* Combine data with current position */
-	SRL::Vector v = Vector(getDirection(), d);
+	// Written atomically, controlHeading() reads the position when it preempts this
+	SRL_ATOMIC_BEGIN();
 	this->x += v.getX();
 	this->y += v.getY();
+	SRL_ATOMIC_END();
 
 	/* Check current movement */
 	if (movingStraight)
@@ -207,46 +894,175 @@ void SRL::Rover::updatePosition(void)
 			stop();
 		}
 	}
+}
 
-	if (turning)
+/**
+*	Compares the wheels' acceleration and turn rate with the AccelGyro's, and
+*	returns the distance the rover traveled since the previous update. The
+*	velocity is estimated from the AccelGyro's acceleration, corrected
+*	towards the encoders' velocity. The wheels slip if their acceleration or
+*	turn rate differs from the AccelGyro's by more than its limit, or their
+*	velocity from the estimate by more than ROVER_SLIP_VELOCITY. isSlipping()
+*	is then true until no slip was detected for ROVER_SLIP_HOLD us, and the
+*	distance is taken from the estimate, which follows the encoders only by
+*	ROVER_SLIP_ENCODER_WEIGHT. While both wheels stand still, the rover is
+*	taken to stand, which resets the estimate and learns the AccelGyro's
+*	bias. The AccelGyro's y axis must point forwards, and its samples must be
+*	fresh, otherwise the encoders' distance is used.
+*
+*	@param left The distance the left wheel traveled in cm.
+*	@param right The distance the right wheel traveled in cm.
+*/
+double SRL::Rover::detectSlip(double left, double right)
+{
+	const float dt = UPDATE_POSITION_INTERVAL / 1000000.0f;
+	unsigned long now = micros();
+
+	double velocity = (left + right) / 2.0 / dt;
+	double acceleration = (velocity - encoderVelocity) / dt;
+	encoderVelocity = velocity;
+
+	SRL::Sample<SRL::Axes> gyro = accelGyro->getGyroSample();
+	SRL::Sample<SRL::Axes> accel = accelGyro->getAccelSample();
+
+	if (gyro.timestamp == 0 || gyro.getAge(now) >= ROVER_GYRO_TIMEOUT
+		|| accel.timestamp == 0 || accel.getAge(now) >= ROVER_GYRO_TIMEOUT)
+	{
+		slipping = false;
+		slipVelocity = velocity;
+		return (left + right) / 2.0;
+	}
+
+	float rate = (left - right) / trackWidth * 180 / PI / dt;
+	float gyroRate = -gyro.value.z;
+	double measured = accel.value.y * ROVER_GRAVITY - accelBias;
+	double residual = measured - acceleration;
+
+	// Wheels that do not turn do not slip, the rover stands
+	if (left == 0.0 && right == 0.0)
+	{
+		accelBias += ROVER_SLIP_BIAS_GAIN * residual;
+		slipping = false;
+		slipVelocity = 0.0;
+		return 0.0;
+	}
+
+	slipVelocity += measured * dt;
+	double innovation = velocity - slipVelocity;
+
+	if (fabs(residual) > ROVER_SLIP_ACCELERATION || fabs(innovation) > ROVER_SLIP_VELOCITY
+		|| fabs(rate - gyroRate) > ROVER_SLIP_YAW_RATE + ROVER_SLIP_YAW_FRACTION * fabs(gyroRate))
+	{
+		if (!slipping)
+		{
+			slipCount++;
+		}
+
+		slipping = true;
+		slipTime = now;
+	}
+	else if (!slipping)
 	{
+		accelBias += ROVER_SLIP_BIAS_GAIN * residual;
+	}
+	else if (now - slipTime >= ROVER_SLIP_HOLD)
+	{
+		slipping = false;
+	}
 
+	if (!slipping)
+	{
+		slipVelocity += ROVER_SLIP_GRIP_WEIGHT * innovation;
+		return (left + right) / 2.0;
 	}
+
+	slipVelocity += ROVER_SLIP_ENCODER_WEIGHT * innovation;
+	return slipVelocity * dt;
+}
+
+void SRL::Rover::correctMotorsTask(void* rover)
+{
+	((SRL::Rover*) rover)->correctMotors();
+}
+
+void SRL::Rover::controlHeadingTask(void* rover)
+{
+	((SRL::Rover*) rover)->controlHeading();
 }
 
-float SRL::Rover::getCorrectionSpeed(float x)
+void SRL::Rover::updatePositionTask(void* rover)
 {
-	return (0 - 0.19 * x + 99.64);
+	((SRL::Rover*) rover)->updatePosition();
 }
 
+/**
+*	The pose is written by the executive's tasks, so it is read and written
+*	with interrupts disabled.
+*/
 float SRL::Rover::getDirection(void)
 {
-	return direction.getSize();
+	SRL_ATOMIC_BEGIN();
+	float size = direction.getSize();
+	SRL_ATOMIC_END();
+
+	return size;
 }
 
 void SRL::Rover::setDirection(float direction)
 {
-	this->direction = SRL::Angle(direction);
+	SRL::Angle angle(direction);
+
+	SRL_ATOMIC_BEGIN();
+	this->direction = angle;
+	SRL_ATOMIC_END();
+}
+
+/**
+*	Copies the position and the direction at the same instant.
+*
+*	@param x The x coordinate in cm.
+*	@param y The y coordinate in cm.
+*	@param direction The direction in degrees.
+*/
+void SRL::Rover::getPose(double* x, double* y, float* direction)
+{
+	SRL_ATOMIC_BEGIN();
+	*x = this->x;
+	*y = this->y;
+	*direction = this->direction.getSize();
+	SRL_ATOMIC_END();
 }
 
 double SRL::Rover::getX(void)
 {
+	SRL_ATOMIC_BEGIN();
+	double x = this->x;
+	SRL_ATOMIC_END();
+
 	return x;
 }
 
 void SRL::Rover::setX(double x)
 {
+	SRL_ATOMIC_BEGIN();
 	this->x = x;
+	SRL_ATOMIC_END();
 }
 
 double SRL::Rover::getY(void)
 {
+	SRL_ATOMIC_BEGIN();
+	double y = this->y;
+	SRL_ATOMIC_END();
+
 	return y;
 }
 
 void SRL::Rover::setY(double y)
 {
+	SRL_ATOMIC_BEGIN();
 	this->y = y;
+	SRL_ATOMIC_END();
 }
 
 void SRL::Rover::setAccelGyro(AccelGyro* accelGyro)
@@ -257,11 +1073,13 @@ void SRL::Rover::setAccelGyro(AccelGyro* accelGyro)
 void SRL::Rover::setLeftEncoder(Encoder* leftEncoder)
 {
 	this->leftEncoder = leftEncoder;
+	leftSpeed.setEncoder(leftEncoder);
 }
 
 void SRL::Rover::setRightEncoder(Encoder* rightEncoder)
 {
 	this->rightEncoder = rightEncoder;
+	rightSpeed.setEncoder(rightEncoder);
 }
 
 SRL::AccelGyro* SRL::Rover::getAccelGyro(void)
@@ -288,3 +1106,123 @@ SRL::Motor* SRL::Rover::getRightMotor(void)
 {
 	return rightMotor;
 }
+
+/**
+*	Sets the speed the rover moves and turns at.
+*
+*	@param cruiseSpeed The speed of the wheels in cm/s.
+*/
+void SRL::Rover::setCruiseSpeed(double cruiseSpeed)
+{
+	profile.setLimits(cruiseSpeed, profile.getMaxAcceleration(), profile.getMaxJerk());
+}
+
+double SRL::Rover::getCruiseSpeed(void)
+{
+	return profile.getMaxVelocity();
+}
+
+SRL::SpeedController* SRL::Rover::getLeftSpeedController(void)
+{
+	return &leftSpeed;
+}
+
+SRL::SpeedController* SRL::Rover::getRightSpeedController(void)
+{
+	return &rightSpeed;
+}
+
+/**
+*	Returns the motion profile of the rover's moves, e.g. to change its
+*	acceleration and jerk limits.
+*/
+SRL::MotionProfile* SRL::Rover::getMotionProfile(void)
+{
+	return &profile;
+}
+
+/**
+*	Sets the distance between the wheels, used to turn the rover in place.
+*	Kept by the Tank, so its arcs and the rover's kinematics share it.
+*
+*	@param trackWidth The distance in cm.
+*/
+void SRL::Rover::setTrackWidth(double trackWidth)
+{
+	Tank::setTrackWidth(trackWidth);
+}
+
+double SRL::Rover::getTrackWidth(void)
+{
+	return Tank::getTrackWidth();
+}
+
+/**
+*	Returns whether the wheels slip, detected by updatePosition() from the
+*	AccelGyro's samples.
+*/
+bool SRL::Rover::isSlipping(void)
+{
+	return slipping;
+}
+
+/**
+*	Returns the number of times the wheels started slipping.
+*/
+unsigned int SRL::Rover::getSlipCount(void)
+{
+	SRL_ATOMIC_BEGIN();
+	unsigned int count = slipCount;
+	SRL_ATOMIC_END();
+
+	return count;
+}
+
+/**
+*	Sets whether the wheels' speed is cut to the rover's while they slip, so
+*	they grip again. Moves made with forward() or backward() end short then.
+*
+*	@param tractionControl True to cut the speed.
+*/
+void SRL::Rover::setTractionControl(bool tractionControl)
+{
+	this->tractionControl = tractionControl;
+}
+
+bool SRL::Rover::getTractionControl(void)
+{
+	return tractionControl;
+}
+
+/**
+*	Learns the bias of the AccelGyro's gyroscope while the rover stands, so
+*	it does not drift without stopping the rover to calibrate it. Call it
+*	from loop(): it reads the gyroscope over I2C, which the executive's tasks
+*	can not. It only learns once updatePosition() saw both wheels stand
+*	still without a command for ROVER_GYRO_BIAS_STILL_TIME, and at most every
+*	ROVER_GYRO_BIAS_INTERVAL.
+*
+*	@return
+*	Returns 0 if the bias was learned, 1 otherwise.
+*/
+uint8_t SRL::Rover::learnGyroBias(void)
+{
+	if (accelGyro == NULL)
+	{
+		return 1;
+	}
+
+	unsigned long now = micros();
+
+	SRL_ATOMIC_BEGIN();
+	bool still = standing && now - standingSince >= ROVER_GYRO_BIAS_STILL_TIME;
+	SRL_ATOMIC_END();
+
+	if (!still || (gyroBiasTime != 0 && now - gyroBiasTime < ROVER_GYRO_BIAS_INTERVAL))
+	{
+		return 1;
+	}
+
+	gyroBiasTime = now;
+	return accelGyro->learnGyroBias();
+}
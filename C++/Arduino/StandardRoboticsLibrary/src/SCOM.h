@@ -25,8 +25,10 @@
 #define SRL_SCOM_H
 
 #include "SRL.h"
+#include "CRC.h"
 
 #define VERSION 1204
+#define SCOM_VERSION_2 2000
 
 #define SOH 1
 #define STX 2
@@ -44,12 +46,42 @@
 #define COMMAND_MODE 6
 #define IN_TIMEOUT_BUFFER 7
 
+// SCOM2000 frames: type, sequence number, payload and CRC16 of them, COBS
+// encoded and ended by a 0 byte. A SCOM1204 master starts with a 0 byte.
+#define SCOM_FRAME_DELIMITER 0
+#define SCOM_MAX_PAYLOAD 64
+#define SCOM_FRAME_OVERHEAD 4
+#define SCOM_MAX_FRAME (SCOM_MAX_PAYLOAD + SCOM_FRAME_OVERHEAD)
+#define SCOM_MAX_ENCODED (SCOM_MAX_FRAME + SCOM_MAX_FRAME / 254 + 1)
+
+#define SCOM_FRAME_HELLO 1
+#define SCOM_FRAME_COMMAND 2
+#define SCOM_FRAME_CLOSE 4
+#define SCOM_FRAME_ACK 6
+#define SCOM_FRAME_NAK 21
+#define SCOM_FRAME_TELEMETRY 32
+
 namespace SRL
 {
+	/**
+	*	A view of received bytes, valid until the receiver reuses its buffer.
+	*/
+	struct Payload
+	{
+		const byte* data;
+		uint8_t length;
+	};
+
+
 	int16_t calculateSum(String str);
+	int16_t calculateSum(const char* str);
 	int16_t calculateSum(int16_t num);
 	void sendInt16(int16_t signal);
 	int16_t readInt16(void);
+
+	uint8_t cobsEncode(const byte* data, uint8_t len, byte* out);
+	uint8_t cobsDecode(byte* data, uint8_t len);
+	uint8_t encodeFrame(uint8_t type, uint8_t sequence, const byte* payload, uint8_t len, byte* out);
 }
 
 #endif
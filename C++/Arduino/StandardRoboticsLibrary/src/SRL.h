@@ -31,6 +31,15 @@
 #include "WProgram.h"
 #endif
 
+// Critical section that keeps the caller's interrupt flag, so it can be used in ISRs too
+#if defined(__AVR__)
+#define SRL_ATOMIC_BEGIN() uint8_t srlOldSREG = SREG; cli()
+#define SRL_ATOMIC_END() SREG = srlOldSREG
+#else
+#define SRL_ATOMIC_BEGIN() noInterrupts()
+#define SRL_ATOMIC_END() interrupts()
+#endif
+
 namespace SRL
 {
 	const unsigned int PWM_MAX_VALUE = 255;
@@ -0,0 +1,65 @@
+/*
+* MIT License
+*
+* Copyright (c) 2021 Robert Hutter
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+#ifndef _SAMPLE_H
+#define _SAMPLE_H
+
+#include "SRL.h"
+
+namespace SRL
+{
+  /**
+  * A reading of a sensor together with the time it was captured at.
+  * The timestamp is in micros(), 0 means no reading has been taken yet.
+  */
+  template <typename T>
+  struct Sample
+  {
+    Sample(T value = T(), unsigned long timestamp = 0)
+    {
+      this->value = value;
+      this->timestamp = timestamp;
+    }
+
+    /* Microseconds between the capture and now */
+    unsigned long getAge(unsigned long now)
+    {
+      return now - timestamp;
+    }
+
+    T value;
+    unsigned long timestamp;
+  };
+
+  /**
+  * Readings of a three axis sensor.
+  */
+  struct Axes
+  {
+    double x;
+    double y;
+    double z;
+  };
+}
+
+#endif
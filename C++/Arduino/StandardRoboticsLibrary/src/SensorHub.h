@@ -0,0 +1,81 @@
+/*
+* MIT License
+*
+* Copyright (c) 2021 Robert Hutter
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+#ifndef _SENSORHUB_H
+#define _SENSORHUB_H
+
+#include "SRL.h"
+#include "Component.h"
+
+#define SENSOR_HUB_MAX_SENSORS 8
+#define SENSOR_HUB_DEFAULT_BUDGET 2000
+
+namespace SRL
+{
+  /**
+  * Class SensorHub. Samples registered components at their target rates.
+  * run() is called from loop() and only takes the samples that are due and
+  * whose estimated cost fits into its time budget, so the loop never waits
+  * for a sensor. A sonar, whose ping can take 30 ms, needs a budget that
+  * large or has to be sampled outside the hub. The
+  * latest readings are read through the components' get*Sample getters.
+  */
+  class SensorHub
+  {
+    public:
+      SensorHub(unsigned long budget = SENSOR_HUB_DEFAULT_BUDGET);
+
+      int8_t add(SRL::Component* component, unsigned int rate, unsigned long cost);
+      uint8_t run(void);
+      void resetCounters(void);
+
+      /* Getters & setters */
+      unsigned long getBudget(void);
+      void setBudget(unsigned long budget);
+      uint8_t getCount(void);
+      unsigned int getOverruns(void);
+
+      SRL::Component* getComponent(uint8_t index);
+      unsigned long getCost(uint8_t index);
+      unsigned int getMisses(uint8_t index);
+
+    private:
+      typedef struct
+      {
+        SRL::Component* component;
+        unsigned long period;
+        unsigned long cost;
+        unsigned long due;
+        unsigned int misses;
+      } Task;
+
+      Task tasks[SENSOR_HUB_MAX_SENSORS];
+      uint8_t count;
+      unsigned long budget;
+      unsigned int overruns;
+
+      int8_t next(unsigned long now, unsigned long remaining);
+  };
+}
+
+#endif
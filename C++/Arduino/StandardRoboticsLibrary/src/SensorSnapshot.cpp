@@ -0,0 +1,215 @@
+/*
+* MIT License
+*
+* Copyright (c) 2021 Robert Hutter
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+#include "SensorSnapshot.h"
+
+/**
+* Class SensorSnapshot's constructor.
+*/
+SRL::SensorSnapshot::SensorSnapshot(void)
+{
+
+}
+
+/**
+* Assembles a snapshot aligned to the IMU reading, or to the time of the
+* capture without an IMU. The IMU, barometer and sonar readings are the
+* samples last taken by their sample* methods, so capturing never waits for
+* a bus transaction or a ping. The encoders are read together and their
+* counts interpolated to the snapshot's timestamp. The barometer and sonar
+* readings keep their own timestamps, skew tells how far they are off.
+*
+* @return
+* Returns the snapshot.
+*/
+SRL::Snapshot SRL::SensorSnapshot::capture(void)
+{
+  Snapshot snapshot;
+
+  snapshot.timestamp = micros();
+
+  if (accelGyro != NULL)
+  {
+    snapshot.accel = accelGyro->getAccelSample();
+    snapshot.gyro = accelGyro->getGyroSample();
+
+    if (snapshot.accel.timestamp != 0)
+      snapshot.timestamp = snapshot.accel.timestamp;
+  }
+
+  if (barometer != NULL)
+    snapshot.pressure = barometer->getPressureSample();
+
+  if (sonar != NULL)
+    snapshot.range = sonar->getPingSample();
+
+  readEncoders(&snapshot);
+
+  snapshot.skew = distance(snapshot.gyro.timestamp, snapshot.timestamp);
+
+  unsigned long skew = distance(snapshot.pressure.timestamp, snapshot.timestamp);
+  if (skew > snapshot.skew)
+    snapshot.skew = skew;
+
+  skew = distance(snapshot.range.timestamp, snapshot.timestamp);
+  if (skew > snapshot.skew)
+    snapshot.skew = skew;
+
+  return snapshot;
+}
+
+/**
+* Reads the encoders at the same instant and interpolates their counts
+* between the previous capture's reading and this one to the snapshot's
+* timestamp.
+*
+* @param snapshot The snapshot to fill in.
+*/
+void SRL::SensorSnapshot::readEncoders(Snapshot* snapshot)
+{
+  Encoder* encoders[2];
+  Sample<long>* counts[2];
+  Sample<long>* aligned[2];
+  long positions[2];
+  uint8_t count = 0;
+
+  if (leftEncoder != NULL)
+  {
+    encoders[count] = leftEncoder;
+    aligned[count] = &snapshot->leftCount;
+    counts[count++] = &leftCount;
+  }
+
+  if (rightEncoder != NULL)
+  {
+    encoders[count] = rightEncoder;
+    aligned[count] = &snapshot->rightCount;
+    counts[count++] = &rightCount;
+  }
+
+  if (count == 0)
+    return;
+
+  Encoder::snapshot(encoders, positions, count);
+  unsigned long now = micros();
+
+  for (uint8_t i = 0; i < count; i++)
+  {
+    Sample<long> previous = *counts[i];
+    *counts[i] = Sample<long>(positions[i], now);
+
+    if (previous.timestamp == 0)
+      previous = *counts[i];
+
+    *aligned[i] = interpolate(previous, *counts[i], snapshot->timestamp);
+  }
+}
+
+/**
+* Linearly interpolates a count between two readings. Times outside the
+* readings are clamped to them, as counts are not extrapolated.
+*
+* @param from The earlier reading.
+* @param to The later reading.
+* @param time The time to interpolate to.
+*
+* @return
+* Returns the count at time, or at the nearest reading.
+*/
+SRL::Sample<long> SRL::SensorSnapshot::interpolate(Sample<long> from, Sample<long> to, unsigned long time)
+{
+  long span = (long) (to.timestamp - from.timestamp);
+  long offset = (long) (time - from.timestamp);
+
+  if (span <= 0 || offset >= span)
+    return to;
+
+  if (offset <= 0)
+    return from;
+
+  double ratio = (double) offset / span;
+  return Sample<long>(from.value + lround((to.value - from.value) * ratio), time);
+}
+
+/**
+* Returns the microseconds between a reading and a time, 0 for missing
+* readings.
+*/
+unsigned long SRL::SensorSnapshot::distance(unsigned long timestamp, unsigned long time)
+{
+  if (timestamp == 0)
+    return 0;
+
+  long difference = (long) (time - timestamp);
+  return difference < 0 ? -difference : difference;
+}
+
+void SRL::SensorSnapshot::setAccelGyro(SRL::AccelGyro* accelGyro)
+{
+  this->accelGyro = accelGyro;
+}
+
+void SRL::SensorSnapshot::setBarometer(SRL::BMP280* barometer)
+{
+  this->barometer = barometer;
+}
+
+void SRL::SensorSnapshot::setLeftEncoder(SRL::Encoder* leftEncoder)
+{
+  this->leftEncoder = leftEncoder;
+}
+
+void SRL::SensorSnapshot::setRightEncoder(SRL::Encoder* rightEncoder)
+{
+  this->rightEncoder = rightEncoder;
+}
+
+void SRL::SensorSnapshot::setSonar(SRL::Sonar* sonar)
+{
+  this->sonar = sonar;
+}
+
+SRL::AccelGyro* SRL::SensorSnapshot::getAccelGyro(void)
+{
+  return accelGyro;
+}
+
+SRL::BMP280* SRL::SensorSnapshot::getBarometer(void)
+{
+  return barometer;
+}
+
+SRL::Encoder* SRL::SensorSnapshot::getLeftEncoder(void)
+{
+  return leftEncoder;
+}
+
+SRL::Encoder* SRL::SensorSnapshot::getRightEncoder(void)
+{
+  return rightEncoder;
+}
+
+SRL::Sonar* SRL::SensorSnapshot::getSonar(void)
+{
+  return sonar;
+}
@@ -0,0 +1,95 @@
+/*
+* MIT License
+*
+* Copyright (c) 2021 Robert Hutter
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+#ifndef _SENSORSNAPSHOT_H
+#define _SENSORSNAPSHOT_H
+
+#include "SRL.h"
+#include "Sample.h"
+#include "AccelGyro.h"
+#include "BMP280.h"
+#include "Encoder.h"
+#include "Sonar.h"
+
+namespace SRL
+{
+  /**
+  * The latest readings of a robot's sensors, aligned to timestamp. Every
+  * reading keeps the time it stands for, readings of missing sensors have a
+  * timestamp of 0. skew is the largest distance in microseconds between a
+  * reading and timestamp.
+  */
+  struct Snapshot
+  {
+    unsigned long timestamp;
+    unsigned long skew;
+    Sample<Axes> accel;
+    Sample<Axes> gyro;
+    Sample<double> pressure;
+    Sample<long> leftCount;
+    Sample<long> rightCount;
+    Sample<unsigned long> range;
+  };
+
+  /**
+  * Class SensorSnapshot. Assembles the latest readings of the IMU, barometer,
+  * encoders and sonar into one Snapshot for control and logging.
+  */
+  class SensorSnapshot
+  {
+    public:
+      SensorSnapshot(void);
+
+      Snapshot capture(void);
+
+      /* Getters & setters */
+      void setAccelGyro(SRL::AccelGyro* accelGyro);
+      void setBarometer(SRL::BMP280* barometer);
+      void setLeftEncoder(SRL::Encoder* leftEncoder);
+      void setRightEncoder(SRL::Encoder* rightEncoder);
+      void setSonar(SRL::Sonar* sonar);
+
+      SRL::AccelGyro* getAccelGyro(void);
+      SRL::BMP280* getBarometer(void);
+      SRL::Encoder* getLeftEncoder(void);
+      SRL::Encoder* getRightEncoder(void);
+      SRL::Sonar* getSonar(void);
+
+    private:
+      SRL::AccelGyro* accelGyro = NULL;
+      SRL::BMP280* barometer = NULL;
+      SRL::Encoder* leftEncoder = NULL;
+      SRL::Encoder* rightEncoder = NULL;
+      SRL::Sonar* sonar = NULL;
+
+      // Encoder readings of the previous capture, to interpolate from
+      Sample<long> leftCount;
+      Sample<long> rightCount;
+
+      void readEncoders(Snapshot* snapshot);
+      static Sample<long> interpolate(Sample<long> from, Sample<long> to, unsigned long time);
+      static unsigned long distance(unsigned long timestamp, unsigned long time);
+  };
+}
+
+#endif
@@ -25,6 +25,11 @@
 #define SCOM_SLAVE_H
 
 #include "SCOM.h"
+#include "CommandTable.h"
+
+#define SCOM_MAX_COMMAND SCOM_MAX_PAYLOAD
+#define SCOM_TIMEOUT 2000 // ms, a handshake or exchange the master stops answering is abandoned after this long
+#define SCOM_WINDOW 4 // commands the master may send ahead of the ACKs, a power of two up to 8
 
 namespace SRL
 {
@@ -34,9 +39,30 @@ namespace SRL
 			Slave(void);
 			~Slave(void);
 			
-			uint8_t openSCOM(unsigned int baudRate);
+			void openSCOM(unsigned int baudRate);
 			void updateSCOM(void);
 			
+			bool available(void);
+			const char* readCommand(void);
+			SRL::Payload readPayload(void);
+			
+			void setCommandTable(SRL::CommandTable* commands);
+			SRL::CommandTable* getCommandTable(void);
+			uint16_t getVersion(void);
+			uint8_t getWindow(void);
+			
+			uint8_t getLinkState(void);
+			bool isOpen(void);
+			
+			/* Enums */
+			enum LinkState
+			{
+				LINK_CLOSED,
+				LINK_CONNECTING,
+				LINK_OPEN,
+				LINK_LOST
+			};
+			
 		private:
 			int16_t lastMasterSignal;
 			int16_t lastSlaveSignal;
@@ -44,7 +70,55 @@ namespace SRL
 			unsigned int status;
 			unsigned int mode;
 			
-			void waitForUpdate(void);
+			/* Link related fields */
+			uint8_t linkState;
+			uint8_t protocol;
+			uint8_t handshake;
+			unsigned long lastActivity;
+			
+			/* SCOM2000 related fields */
+			uint16_t version;
+			byte rxFrame[SCOM_MAX_FRAME];
+			uint8_t rxLength;
+			bool rxOverflow;
+			uint8_t cobsCode;
+			uint8_t cobsLeft;
+			unsigned long lastFrame;
+			bool corrupted;
+			
+			/* Sliding window related fields */
+			uint8_t window;
+			uint8_t expected;
+			uint8_t base;
+			uint8_t received;
+			byte slots[SCOM_WINDOW][SCOM_MAX_COMMAND + 1];
+			uint8_t slotLength[SCOM_WINDOW];
+			
+			/* Received command, a view into rxFrame or a slot */
+			SRL::Payload command;
+			bool commandReady;
+			bool commandHeld;
+			SRL::CommandTable* commands;
+			
+			enum Protocol
+			{
+				PROTOCOL_NONE,
+				PROTOCOL_SCOM1204,
+				PROTOCOL_SCOM2000
+			};
+			
+			void reset(void);
+			void watchTimeout(void);
+			void updateSignals(void);
+			void receiveCommand(void);
+			void advanceHandshake(void);
+			void updateFrames(void);
+			void receiveByte(byte data);
+			void receiveFrame(void);
+			void deliverCommand(void);
+			void storeCommand(uint8_t sequence, const byte* payload, uint8_t len);
+			void sendAck(void);
+			void sendFrame(uint8_t type, uint8_t sequence, const byte* payload = NULL, uint8_t len = 0);
 	};
 }
 
@@ -188,3 +188,35 @@ void SRL::Sonar::setMaxDistance(double cm)
 {
     this->maxDistance = convertUs(cm);
 }
+
+/**
+* Pings the objects in front of the sensor and stamps the reading with the
+* time the sound reached the object. The sample is kept for getPingSample().
+*
+* @return
+* Returns the ping in micro seconds, NO_ECHO if nothing was detected.
+*/
+SRL::Sample<unsigned long> SRL::Sonar::samplePing(void)
+{
+    unsigned long start = micros();
+    unsigned long us = ping();
+
+    pingSample = Sample<unsigned long>(us, start + us / 2);
+    return pingSample;
+}
+
+/**
+* Returns the last sample taken by samplePing() without pinging.
+*/
+SRL::Sample<unsigned long> SRL::Sonar::getPingSample(void)
+{
+    return pingSample;
+}
+
+/**
+* Takes a sample of the distance. Used by SensorHub.
+*/
+void SRL::Sonar::sample(void)
+{
+    samplePing();
+}
@@ -0,0 +1,279 @@
+/*
+* MIT License
+*
+* Copyright (c) 2021 Robert Hutter
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+#include "SpeedController.h"
+
+/**
+*	Constructor of class SpeedController.
+*
+*	@param motor The motor to drive.
+*	@param encoder The encoder measuring the motor's speed.
+*	@param kp Proportional gain.
+*	@param ki Integral gain, per update.
+*	@param kd Derivative gain, per update.
+*	@param kf Feedforward gain of the target speed.
+*/
+SRL::SpeedController::SpeedController(SRL::Motor* motor, SRL::Encoder* encoder, long kp, long ki, long kd, long kf)
+{
+	this->motor = motor;
+	this->encoder = encoder;
+	speedMap = NULL;
+	reversed = false;
+	target = 0;
+	reset();
+	setGains(kp, ki, kd, kf);
+}
+
+/**
+*	Measures the velocity and sets the motor's power and direction.
+*/
+void SRL::SpeedController::update(void)
+{
+	if (motor == NULL || encoder == NULL)
+	{
+		return;
+	}
+
+	stage();
+	motor->commit();
+}
+
+/**
+*	Measures the velocity and stages the motor's power and direction, for
+*	Motor::commit() to output them together with another motor's. The
+*	integral stops growing while the output is saturated in the direction
+*	of the error, so it does not wind up.
+*/
+void SRL::SpeedController::stage(void)
+{
+	if (motor == NULL || encoder == NULL)
+	{
+		return;
+	}
+
+	long measured = encoder->sampleVelocity().value;
+	if (reversed)
+	{
+		measured = -measured;
+	}
+
+	long feedforward = kf * limit(target, targetLimit);
+
+	if (speedMap != NULL)
+	{
+		// The motor ran at its duty cycle since the previous update. Standing
+		// still is learned too, that is the deadband, but not braking.
+		bool forward = motor->getDirection() == Motor::FORWARD;
+
+		if (motor->isMoving() && (forward ? measured >= 0 : measured <= 0))
+		{
+			speedMap->learn(motor->getDuty(), labs(measured));
+		}
+		else
+		{
+			speedMap->restart();
+		}
+
+		// At most PWM_MAX_VALUE * SPEED_CONTROLLER_MAX_OUTPUT, which fits in 31 bits
+		feedforward = (long) speedMap->getDuty(labs(target)) * SPEED_CONTROLLER_MAX_OUTPUT / (long) SRL::PWM_MAX_VALUE;
+		if (target < 0)
+		{
+			feedforward = -feedforward;
+		}
+	}
+
+	long error = limit(target - measured, errorLimit);
+	long change = limit(measured - velocity, errorLimit);
+
+	// The derivative is taken of the measurement, so target changes do not kick
+	long sum = feedforward + kp * error + ki * (integral + error) - kd * change;
+
+	velocity = measured;
+
+	if ((sum < SPEED_CONTROLLER_MAX_OUTPUT || error < 0) && (sum > -SPEED_CONTROLLER_MAX_OUTPUT || error > 0))
+	{
+		integral = limit(integral + error, integralLimit);
+	}
+
+	output = limit(sum, SPEED_CONTROLLER_MAX_OUTPUT);
+
+	// Percent to duty cycle in integers, the control path stays free of float math
+	uint8_t duty = ((unsigned long) labs(output) * SRL::PWM_MAX_VALUE + SPEED_CONTROLLER_MAX_OUTPUT / 2)
+		/ SPEED_CONTROLLER_MAX_OUTPUT;
+
+	motor->stageDirection((output >= 0) ? Motor::FORWARD : Motor::BACKWARD);
+	motor->stageDuty(duty);
+}
+
+/**
+*	Clears the integral and the derivative's history.
+*/
+void SRL::SpeedController::reset(void)
+{
+	velocity = 0;
+	integral = 0;
+	output = 0;
+}
+
+/**
+*	Sets the commanded speed.
+*
+*	@param target The speed in encoder steps per second, negative is backwards.
+*/
+void SRL::SpeedController::setTarget(long target)
+{
+	this->target = target;
+}
+
+long SRL::SpeedController::getTarget(void)
+{
+	return target;
+}
+
+/**
+*	Returns the velocity measured by the last update in steps per second.
+*/
+long SRL::SpeedController::getVelocity(void)
+{
+	return velocity;
+}
+
+/**
+*	Returns the last output in percent of the motor's power, negative is backwards.
+*/
+float SRL::SpeedController::getOutput(void)
+{
+	return (float) output / (1L << SPEED_CONTROLLER_GAIN_SHIFT);
+}
+
+/**
+*	Sets the controller's gains.
+*
+*	@param kp Proportional gain.
+*	@param ki Integral gain, per update.
+*	@param kd Derivative gain, per update.
+*	@param kf Feedforward gain of the target speed.
+*/
+void SRL::SpeedController::setGains(long kp, long ki, long kd, long kf)
+{
+	this->kp = kp;
+	this->ki = ki;
+	this->kd = kd;
+	this->kf = kf;
+
+	// The integral alone never needs to exceed full power
+	integralLimit = (ki > 0) ? SPEED_CONTROLLER_MAX_OUTPUT / ki : 0;
+	integral = limit(integral, integralLimit);
+
+	long gain = (kp > ki) ? kp : ki;
+	gain = (gain > kd) ? gain : kd;
+	errorLimit = SPEED_CONTROLLER_TERM_LIMIT / ((gain > 0) ? gain : 1);
+	targetLimit = SPEED_CONTROLLER_TERM_LIMIT / ((kf > 0) ? kf : 1);
+}
+
+long SRL::SpeedController::getKp(void)
+{
+	return kp;
+}
+
+long SRL::SpeedController::getKi(void)
+{
+	return ki;
+}
+
+long SRL::SpeedController::getKd(void)
+{
+	return kd;
+}
+
+long SRL::SpeedController::getKf(void)
+{
+	return kf;
+}
+
+/**
+*	Sets whether the encoder counts backwards while the motor runs forwards.
+*
+*	@param reversed True if the encoder is mounted reversed.
+*/
+void SRL::SpeedController::setReversed(bool reversed)
+{
+	this->reversed = reversed;
+}
+
+bool SRL::SpeedController::getReversed(void)
+{
+	return reversed;
+}
+
+void SRL::SpeedController::setMotor(SRL::Motor* motor)
+{
+	this->motor = motor;
+}
+
+SRL::Motor* SRL::SpeedController::getMotor(void)
+{
+	return motor;
+}
+
+void SRL::SpeedController::setEncoder(SRL::Encoder* encoder)
+{
+	this->encoder = encoder;
+}
+
+SRL::Encoder* SRL::SpeedController::getEncoder(void)
+{
+	return encoder;
+}
+
+/**
+*	Sets the map the feedforward is looked up in, NULL to scale the target by kf.
+*	Once the map has learned the motor, the integral gain can be lowered.
+*
+*	@param speedMap The motor's speed map.
+*/
+void SRL::SpeedController::setSpeedMap(SRL::SpeedMap* speedMap)
+{
+	this->speedMap = speedMap;
+}
+
+SRL::SpeedMap* SRL::SpeedController::getSpeedMap(void)
+{
+	return speedMap;
+}
+
+/**
+*	Limits a value to the range [-bound, bound].
+*/
+long SRL::SpeedController::limit(long value, long bound)
+{
+	if (value > bound)
+	{
+		return bound;
+	}
+	if (value < -bound)
+	{
+		return -bound;
+	}
+	return value;
+}
@@ -0,0 +1,109 @@
+/*
+* MIT License
+*
+* Copyright (c) 2021 Robert Hutter
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+#ifndef _SPEEDCONTROLLER_H
+#define _SPEEDCONTROLLER_H
+
+#include "SRL.h"
+#include "Motor.h"
+#include "Encoder.h"
+#include "SpeedMap.h"
+
+// Gains are fixed point numbers with SPEED_CONTROLLER_GAIN_SHIFT fraction bits
+#define SPEED_CONTROLLER_GAIN_SHIFT 16
+#define SPEED_CONTROLLER_MAX_OUTPUT (100L << SPEED_CONTROLLER_GAIN_SHIFT)
+
+// Bound of each term, the errors are clamped to it, so the sum fits in 32 bits
+#define SPEED_CONTROLLER_TERM_LIMIT (2 * SPEED_CONTROLLER_MAX_OUTPUT)
+
+#define SPEED_CONTROLLER_DEFAULT_KP 131
+#define SPEED_CONTROLLER_DEFAULT_KI 2
+#define SPEED_CONTROLLER_DEFAULT_KD 0
+#define SPEED_CONTROLLER_DEFAULT_KF 93
+
+namespace SRL
+{
+	/**
+	*	Class SpeedController. Drives a motor to a commanded speed with a PID
+	*	controller on the encoder's velocity and a feedforward of the target.
+	*	update() must be called at a fixed rate, the integral and derivative
+	*	gains are per call. The gains are in percent of motor power per step/s,
+	*	scaled by 2^SPEED_CONTROLLER_GAIN_SHIFT. With a speed map the feedforward
+	*	is looked up in the map instead of scaled by kf, and the map learns from
+	*	the motor while the controller runs. The target and the errors are
+	*	clamped where their terms alone would saturate the output twice over,
+	*	so the control math runs in 32 bit integers.
+	*/
+	class SpeedController
+	{
+		public:
+			SpeedController(SRL::Motor* motor = NULL, SRL::Encoder* encoder = NULL,
+				long kp = SPEED_CONTROLLER_DEFAULT_KP, long ki = SPEED_CONTROLLER_DEFAULT_KI,
+				long kd = SPEED_CONTROLLER_DEFAULT_KD, long kf = SPEED_CONTROLLER_DEFAULT_KF);
+
+			void update(void);
+			void stage(void);
+			void reset(void);
+
+			/* Getters & setters */
+			void setTarget(long target);
+			long getTarget(void);
+			long getVelocity(void);
+			float getOutput(void);
+
+			void setGains(long kp, long ki, long kd, long kf);
+			long getKp(void);
+			long getKi(void);
+			long getKd(void);
+			long getKf(void);
+
+			void setReversed(bool reversed);
+			bool getReversed(void);
+
+			void setMotor(SRL::Motor* motor);
+			SRL::Motor* getMotor(void);
+			void setEncoder(SRL::Encoder* encoder);
+			SRL::Encoder* getEncoder(void);
+			void setSpeedMap(SRL::SpeedMap* speedMap);
+			SRL::SpeedMap* getSpeedMap(void);
+
+		private:
+			static long limit(long value, long bound);
+
+			SRL::Motor* motor;
+			SRL::Encoder* encoder;
+			SRL::SpeedMap* speedMap;
+			bool reversed;
+
+			long kp, ki, kd, kf;
+			long target;
+			long velocity;
+			long integral;
+			long integralLimit;
+			long errorLimit;
+			long targetLimit;
+			long output;
+	};
+}
+
+#endif
@@ -0,0 +1,88 @@
+/*
+* MIT License
+*
+* Copyright (c) 2018 Robert Hutter
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+#ifndef _SPEEDMAP_H
+#define _SPEEDMAP_H
+
+#include "SRL.h"
+
+// The map has a point every SPEED_MAP_POINT_DUTY duty cycle steps
+#define SPEED_MAP_POINTS 16
+#define SPEED_MAP_POINT_DUTY 17
+
+// Full speed of the linear map, in steps/s. Matches SPEED_CONTROLLER_DEFAULT_KF.
+#define SPEED_MAP_DEFAULT_MAX_SPEED 70000L
+
+// Samples are averaged over windows of SPEED_MAP_WINDOW us
+#define SPEED_MAP_WINDOW 50000
+#define SPEED_MAP_DUTY_SHIFT 4
+#define SPEED_MAP_STEADY_DUTY (4 << SPEED_MAP_DUTY_SHIFT)
+#define SPEED_MAP_STEADY_SHIFT 4
+#define SPEED_MAP_LEARN_SHIFT 2
+
+namespace SRL
+{
+	/**
+	*	Class SpeedMap. Maps a motor's duty cycle to the speed it turns at, and
+	*	back. The map starts out linear and learns the motor's real curve,
+	*	including its deadband, from the duty cycles and speeds measured while
+	*	the motor runs steadily. The speeds are in encoder steps per second and
+	*	never decrease with the duty cycle, so the map can be inverted.
+	*/
+	class SpeedMap
+	{
+		public:
+			SpeedMap(long maxSpeed = SPEED_MAP_DEFAULT_MAX_SPEED);
+
+			void reset(long maxSpeed = SPEED_MAP_DEFAULT_MAX_SPEED);
+
+			void learn(uint8_t duty, long speed);
+			void restart(void);
+
+			long getSpeed(uint8_t duty);
+			uint8_t getDuty(long speed);
+
+			/* Getters & setters */
+			long getPoint(uint8_t index);
+
+			/* Calibration storage */
+			uint8_t getCalibrationSize(void);
+			void saveCalibration(byte* data);
+			void loadCalibration(const byte* data);
+
+		private:
+			long interpolate(unsigned int duty);
+			void update(unsigned int duty, long speed);
+
+			int32_t speeds[SPEED_MAP_POINTS];
+
+			unsigned long windowStart;
+			unsigned long dutySum;
+			long speedSum;
+			unsigned int samples;
+			int lastDuty;
+			long lastSpeed;
+	};
+}
+
+#endif
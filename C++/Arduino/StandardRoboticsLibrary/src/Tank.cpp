@@ -33,6 +33,7 @@ SRL::Tank::Tank(SRL::Motor* leftMotor, SRL::Motor* rightMotor)
 {
   this->leftMotor = leftMotor;
   this->rightMotor = rightMotor;
+  this->trackWidth = TANK_DEFAULT_TRACK_WIDTH;
 }
 
 SRL::Tank::~Tank(void)
@@ -46,8 +47,9 @@ SRL::Tank::~Tank(void)
 */
 void SRL::Tank::start(void)
 {
-  leftMotor->start();
-  rightMotor->start();
+  leftMotor->stageMoving(true);
+  rightMotor->stageMoving(true);
+  Motor::commit(leftMotor, rightMotor);
 }
 
 /**
@@ -55,8 +57,9 @@ void SRL::Tank::start(void)
 */
 void SRL::Tank::stop(void)
 {
-  leftMotor->stop();
-  rightMotor->stop();
+  leftMotor->stageMoving(false);
+  rightMotor->stageMoving(false);
+  Motor::commit(leftMotor, rightMotor);
 }
 
 /**
@@ -65,8 +68,9 @@ void SRL::Tank::stop(void)
 */
 void SRL::Tank::faceLeft(void)
 {
-  leftMotor->backwards();
-  rightMotor->forwards();
+  leftMotor->stageDirection(Motor::BACKWARD);
+  rightMotor->stageDirection(Motor::FORWARD);
+  Motor::commit(leftMotor, rightMotor);
   direction = LEFT;
 }
 
@@ -76,8 +80,9 @@ void SRL::Tank::faceLeft(void)
 */
 void SRL::Tank::faceRight(void)
 {
-  leftMotor->forwards();
-  rightMotor->backwards();
+  leftMotor->stageDirection(Motor::FORWARD);
+  rightMotor->stageDirection(Motor::BACKWARD);
+  Motor::commit(leftMotor, rightMotor);
   direction = RIGHT;
 }
 
@@ -86,8 +91,9 @@ void SRL::Tank::faceRight(void)
 */
 void SRL::Tank::forwards(void)
 {
-  leftMotor->forwards();
-  rightMotor->forwards();
+  leftMotor->stageDirection(Motor::FORWARD);
+  rightMotor->stageDirection(Motor::FORWARD);
+  Motor::commit(leftMotor, rightMotor);
   direction = FORWARD;
 }
 
@@ -96,8 +102,9 @@ void SRL::Tank::forwards(void)
 */
 void SRL::Tank::backwards(void)
 {
-  leftMotor->backwards();
-  rightMotor->backwards();
+  leftMotor->stageDirection(Motor::BACKWARD);
+  rightMotor->stageDirection(Motor::BACKWARD);
+  Motor::commit(leftMotor, rightMotor);
   direction = BACKWARD;
 }
 
@@ -108,8 +115,63 @@ void SRL::Tank::backwards(void)
 */
 void SRL::Tank::setUnifiedSpeed(float speed)
 {
-  leftMotor->setSpeed(speed);
-  rightMotor->setSpeed(speed);
+  leftMotor->stageSpeed(speed);
+  rightMotor->stageSpeed(speed);
+  Motor::commit(leftMotor, rightMotor);
+}
+
+/**
+* Sets the speed and direction of each motor. The tank's direction is
+* FORWARD or BACKWARD if both motors turn that way, otherwise the side
+* it turns to.
+*
+* @param left The left motor's speed, negative is backwards.
+* @param right The right motor's speed, negative is backwards.
+*/
+void SRL::Tank::setWheelSpeeds(float left, float right)
+{
+  leftMotor->stageDirection((left >= 0) ? Motor::FORWARD : Motor::BACKWARD);
+  rightMotor->stageDirection((right >= 0) ? Motor::FORWARD : Motor::BACKWARD);
+  leftMotor->stageSpeed(fabs(left));
+  rightMotor->stageSpeed(fabs(right));
+  Motor::commit(leftMotor, rightMotor);
+
+  if (left >= 0 && right >= 0)
+  {
+    direction = FORWARD;
+  }
+  else if (left <= 0 && right <= 0)
+  {
+    direction = BACKWARD;
+  }
+  else
+  {
+    direction = (left > right) ? RIGHT : LEFT;
+  }
+}
+
+/**
+* Drives the tank along an arc. The outer wheel runs faster than the inner
+* one by the track width times the curvature. If the outer wheel would
+* exceed full speed, both are slowed down so the arc keeps its curvature.
+*
+* @param speed The speed of the tank's center, negative is backwards.
+* @param curvature One over the radius of the arc in 1/cm, positive to the
+* right. 0 drives straight.
+*/
+void SRL::Tank::arc(float speed, double curvature)
+{
+  float left = speed * (1 + curvature * trackWidth / 2);
+  float right = speed * (1 - curvature * trackWidth / 2);
+  float larger = (fabs(left) > fabs(right)) ? fabs(left) : fabs(right);
+
+  if (larger > 100.0f)
+  {
+    left *= 100.0f / larger;
+    right *= 100.0f / larger;
+  }
+
+  setWheelSpeeds(left, right);
 }
 
 /**
@@ -156,3 +218,18 @@ SRL::Motor* SRL::Tank::getRightMotor(void)
 {
   return rightMotor;
 }
+
+/**
+* Sets the distance between the tank's wheels, used by arc().
+*
+* @param trackWidth The distance in cm.
+*/
+void SRL::Tank::setTrackWidth(double trackWidth)
+{
+  this->trackWidth = trackWidth;
+}
+
+double SRL::Tank::getTrackWidth(void)
+{
+  return trackWidth;
+}
@@ -0,0 +1,318 @@
+/*
+* MIT License
+*
+* Copyright (c) 2018 Robert Hutter
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+#include "Telemetry.h"
+
+/**
+*	Constructor for a telemetry publisher with every channel off.
+*
+*/
+SRL::Telemetry::Telemetry(void)
+{
+	for (uint8_t i = 0; i < TELEMETRY_MAX_SONARS; i++)
+	{
+		sonars[i] = NULL;
+	}
+
+	for (uint8_t i = 0; i < CHANNEL_COUNT; i++)
+	{
+		decimation[i] = 0;
+		countdown[i] = 0;
+	}
+
+	queueHead = 0;
+	queueCount = 0;
+	sequence = 0;
+	sent = 0;
+	dropped = 0;
+}
+
+/**
+*	Publishes the channels that are due and sends the queued records the
+*	serial transmit buffer has room for. Call it from loop(), not from an
+*	interrupt, so its frames do not split the SCOM slave's.
+*
+*/
+void SRL::Telemetry::update(void)
+{
+	// Telemetry frames would confuse a SCOM1204 master
+	if (slave != NULL && (!slave->isOpen() || slave->getVersion() < SCOM_VERSION_2))
+	{
+		return;
+	}
+
+	for (uint8_t i = 0; i < CHANNEL_COUNT; i++)
+	{
+		if (decimation[i] != 0 && --countdown[i] == 0)
+		{
+			countdown[i] = decimation[i];
+			sample(i);
+		}
+	}
+
+	transmit();
+}
+
+/**
+*	Sets how often a channel is published.
+*
+*	@param channel One of the Channels.
+*	@param decimation Publishes the channel every decimation-th update(), 0 turns it off.
+*/
+void SRL::Telemetry::setDecimation(uint8_t channel, uint8_t decimation)
+{
+	if (channel >= CHANNEL_COUNT)
+	{
+		return;
+	}
+
+	this->decimation[channel] = decimation;
+	countdown[channel] = decimation;
+}
+
+uint8_t SRL::Telemetry::getDecimation(uint8_t channel)
+{
+	return channel < CHANNEL_COUNT ? decimation[channel] : 0;
+}
+
+/**
+*	Captures a channel's values into a record and publishes it. Channels
+*	without their sources are skipped.
+*
+*	@param channel One of the Channels.
+*/
+void SRL::Telemetry::sample(uint8_t channel)
+{
+	byte record[TELEMETRY_MAX_RECORD];
+	byte* values = record + TELEMETRY_HEADER;
+	unsigned long timestamp = micros();
+	uint8_t len = 0;
+
+	if (channel == CHANNEL_POSE && rover != NULL)
+	{
+		// The pose is updated by an executive task, read it in one piece
+		double x, y;
+		float direction;
+		rover->getPose(&x, &y, &direction);
+
+		putFloat(values, x);
+		putFloat(values + 4, y);
+		putFloat(values + 8, direction);
+		len = 12;
+	}
+	else if (channel == CHANNEL_ANGLES && accelGyro != NULL)
+	{
+		timestamp = accelGyro->getLastUpdate();
+		putFloat(values, accelGyro->getAngleX());
+		putFloat(values + 4, accelGyro->getAngleY());
+		putFloat(values + 8, accelGyro->getAngleZ());
+		len = 12;
+	}
+	else if (channel == CHANNEL_ENCODERS && leftEncoder != NULL && rightEncoder != NULL)
+	{
+		Encoder* encoders[2] = { leftEncoder, rightEncoder };
+		long counts[2];
+		Encoder::snapshot(encoders, counts, 2);
+
+		putLong(values, counts[0]);
+		putLong(values + 4, counts[1]);
+		len = 8;
+	}
+	else if (channel == CHANNEL_SONAR)
+	{
+		// The latest ranges the sonars' sample() took, pinging here would block
+		for (uint8_t i = 0; i < TELEMETRY_MAX_SONARS && sonars[i] != NULL; i++)
+		{
+			putFloat(values + len, sonars[i]->convertCm(sonars[i]->getPingSample().value));
+			len += 4;
+		}
+	}
+
+	if (len == 0)
+	{
+		return;
+	}
+
+	record[0] = channel;
+	putLong(record + 1, timestamp);
+	publish(record, TELEMETRY_HEADER + len);
+}
+
+/**
+*	Encodes a record into the transmit queue. A full queue drops its oldest
+*	record, as fresh values matter more than complete ones.
+*
+*	@param record The record.
+*	@param len The record's length.
+*/
+void SRL::Telemetry::publish(byte* record, uint8_t len)
+{
+	if (queueCount == TELEMETRY_QUEUE)
+	{
+		queueHead = (queueHead + 1) % TELEMETRY_QUEUE;
+		queueCount--;
+		dropped++;
+	}
+
+	uint8_t slot = (queueHead + queueCount) % TELEMETRY_QUEUE;
+	queueLength[slot] = encodeFrame(SCOM_FRAME_TELEMETRY, sequence++, record, len, queue[slot]);
+	queueCount++;
+}
+
+/**
+*	Writes queued records while the serial transmit buffer has room for
+*	them and TELEMETRY_TX_RESERVE more bytes, so writing never waits.
+*
+*/
+void SRL::Telemetry::transmit(void)
+{
+	while (queueCount > 0)
+	{
+		uint8_t len = queueLength[queueHead];
+
+		if (Serial.availableForWrite() < len + TELEMETRY_TX_RESERVE)
+		{
+			return;
+		}
+
+		Serial.write(queue[queueHead], len);
+		queueHead = (queueHead + 1) % TELEMETRY_QUEUE;
+		queueCount--;
+		sent++;
+	}
+}
+
+void SRL::Telemetry::setSlave(SRL::Slave* slave)
+{
+	this->slave = slave;
+}
+
+void SRL::Telemetry::setRover(SRL::Rover* rover)
+{
+	this->rover = rover;
+}
+
+void SRL::Telemetry::setAccelGyro(SRL::AccelGyro* accelGyro)
+{
+	this->accelGyro = accelGyro;
+}
+
+void SRL::Telemetry::setLeftEncoder(SRL::Encoder* leftEncoder)
+{
+	this->leftEncoder = leftEncoder;
+}
+
+void SRL::Telemetry::setRightEncoder(SRL::Encoder* rightEncoder)
+{
+	this->rightEncoder = rightEncoder;
+}
+
+/**
+*	Sets a sonar of the sonar channel. Its ranges come in the order of the
+*	indexes, up to the first index without a sonar.
+*
+*	@param index The sonar's index, below TELEMETRY_MAX_SONARS.
+*	@param sonar The sonar, NULL to remove it.
+*	@return Returns 0 on success, 1 if the index is too large.
+*/
+uint8_t SRL::Telemetry::setSonar(uint8_t index, SRL::Sonar* sonar)
+{
+	if (index >= TELEMETRY_MAX_SONARS)
+	{
+		return 1;
+	}
+
+	sonars[index] = sonar;
+	return 0;
+}
+
+SRL::Slave* SRL::Telemetry::getSlave(void)
+{
+	return slave;
+}
+
+SRL::Rover* SRL::Telemetry::getRover(void)
+{
+	return rover;
+}
+
+SRL::AccelGyro* SRL::Telemetry::getAccelGyro(void)
+{
+	return accelGyro;
+}
+
+SRL::Encoder* SRL::Telemetry::getLeftEncoder(void)
+{
+	return leftEncoder;
+}
+
+SRL::Encoder* SRL::Telemetry::getRightEncoder(void)
+{
+	return rightEncoder;
+}
+
+SRL::Sonar* SRL::Telemetry::getSonar(uint8_t index)
+{
+	return index < TELEMETRY_MAX_SONARS ? sonars[index] : NULL;
+}
+
+/**
+*	Returns the number of records written to the serial port.
+*
+*/
+unsigned long SRL::Telemetry::getSent(void)
+{
+	return sent;
+}
+
+/**
+*	Returns the number of records dropped for newer ones.
+*
+*/
+unsigned long SRL::Telemetry::getDropped(void)
+{
+	return dropped;
+}
+
+/**
+*	Writes a long big endian, like SCOM's int16 signals.
+*
+*/
+void SRL::Telemetry::putLong(byte* data, uint32_t value)
+{
+	data[0] = value >> 24;
+	data[1] = value >> 16;
+	data[2] = value >> 8;
+	data[3] = value;
+}
+
+/**
+*	Writes a float as its IEEE 754 bits, big endian.
+*
+*/
+void SRL::Telemetry::putFloat(byte* data, float value)
+{
+	uint32_t bits;
+	memcpy(&bits, &value, 4);
+	putLong(data, bits);
+}
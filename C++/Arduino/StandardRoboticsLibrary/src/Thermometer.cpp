@@ -22,3 +22,75 @@
 * SOFTWARE.
 */
 #include "Thermometer.h"
+
+SRL::Thermometer::Thermometer(void)
+{
+	temperatureSample = Sample<double>();
+	temperatureAverage = 0;
+	temperatureCount = 0;
+	temperatureWeight = THERMOMETER_DEFAULT_WEIGHT;
+}
+
+/**
+*	Returns the moving average of the recorded temperatures.
+*
+*	@return The average temperature in Celsius, 0 if none was recorded yet.
+*/
+double SRL::Thermometer::getAverageTemperature(void)
+{
+	return temperatureAverage;
+}
+
+/**
+*	Returns the last recorded temperature without reading the device.
+*
+*/
+SRL::Sample<double> SRL::Thermometer::getTemperatureSample(void)
+{
+	return temperatureSample;
+}
+
+/**
+*	Returns the number of temperatures recorded so far.
+*
+*/
+unsigned long SRL::Thermometer::getTemperatureCount(void)
+{
+	return temperatureCount;
+}
+
+unsigned int SRL::Thermometer::getTemperatureWeight(void)
+{
+	return temperatureWeight;
+}
+
+/**
+*	Sets how slowly the average follows the readings. Each new reading moves
+*	the average by 1 / weight of its difference. Weight 1 disables averaging.
+*
+*	@param weight The weight of the average. Default value: 16
+*/
+void SRL::Thermometer::setTemperatureWeight(unsigned int weight)
+{
+	temperatureWeight = (weight == 0) ? 1 : weight;
+}
+
+/**
+*	Records a temperature read by the driver and updates the average.
+*
+*	@param temperature The temperature in Celsius.
+*	@param timestamp The time of the reading in micros().
+*/
+void SRL::Thermometer::recordTemperature(double temperature, unsigned long timestamp)
+{
+	temperatureSample = Sample<double>(temperature, timestamp);
+
+	if (temperatureCount++ == 0)
+	{
+		temperatureAverage = temperature;
+	}
+	else
+	{
+		temperatureAverage += (temperature - temperatureAverage) / temperatureWeight;
+	}
+}
@@ -25,5 +25,39 @@
 #define SRL_THERMOMETER
 
 #include "SRL.h"
+#include "Component.h"
+#include "Sample.h"
+
+#define THERMOMETER_DEFAULT_WEIGHT 16
+
+namespace SRL
+{
+	/**
+	*	Class Thermometer. Temperature of a device that measures it along with
+	*	its other readings. The drivers record the temperature whenever it
+	*	arrives in one of their reads, so getting it costs no bus transactions.
+	*/
+	class Thermometer : virtual public SRL::Component
+	{
+		public:
+			Thermometer(void);
+
+			double getAverageTemperature(void);
+			Sample<double> getTemperatureSample(void);
+			unsigned long getTemperatureCount(void);
+
+			/* Getters & setters */
+			unsigned int getTemperatureWeight(void);
+			void setTemperatureWeight(unsigned int weight);
+
+		protected:
+			void recordTemperature(double temperature, unsigned long timestamp);
+
+			Sample<double> temperatureSample;
+			double temperatureAverage;
+			unsigned long temperatureCount;
+			unsigned int temperatureWeight;
+	};
+}
 
 #endif
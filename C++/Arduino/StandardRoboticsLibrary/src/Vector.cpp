@@ -34,6 +34,7 @@ SRL::Vector::Vector(SRL::Angle direction, double length)
 {
 	this->x = (length * cos(((90 - direction.getSize()) * PI) / 180));
 	this->y = (length * cos((direction.getSize() * PI) / 180));
+	updateLength();
 }
 
 SRL::Vector SRL::Vector::addition(Vector a, Vector b)
@@ -75,7 +76,8 @@ double SRL::Vector::getLength(void)
 
 SRL::Angle SRL::Vector::getAngle(void)
 {
-	return SRL::Angle((sinh(x / length) * PI) / 180);
+	// Clockwise from the y axis, like the direction of the constructor
+	return SRL::Angle((atan2(x, y) * 180) / PI);
 }
 
 void SRL::Vector::setX(double x)
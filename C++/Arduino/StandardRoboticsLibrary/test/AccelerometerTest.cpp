@@ -0,0 +1,146 @@
+/*
+* MIT License
+*
+* Copyright (c) 2021 Robert Hutter
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+/*
+*	AccelerometerTest.cpp - Runs the six-position calibration on a simulated
+*	accelerometer with known offsets and gains.
+*
+*	g++ -DARDUINO=100 -I. -I../src AccelerometerTest.cpp ../src/Accelerometer.cpp ../src/Component.cpp -o AccelerometerTest
+*/
+#include <stdio.h>
+#include "Accelerometer.h"
+
+HardwareSerial Serial;
+
+unsigned long micros(void)
+{
+	return 0;
+}
+
+unsigned long millis(void)
+{
+	return 0;
+}
+
+static int failures = 0;
+
+static void check(const char* name, bool passed)
+{
+	if (!passed)
+	{
+		failures++;
+		printf("FAILED: %s\n", name);
+	}
+}
+
+/**
+*	Simulated accelerometer, turned into the next of the six orientations
+*	after every READS_PER_POSE readings of the x-axis.
+*/
+class SimulatedAccelerometer : public SRL::Accelerometer
+{
+	public:
+		static const long READS_PER_POSE = 1000;
+		static const long SENSITIVITY = 16384; // LSB per g, like the MPU6050 at +-2 g
+
+		double gain[3];
+		int16_t offset[3];
+		long reads;
+
+		SimulatedAccelerometer(void)
+		{
+			gain[0] = 1.02; gain[1] = 0.97; gain[2] = 1.05;
+			offset[0] = 150; offset[1] = -320; offset[2] = 800;
+			reads = 0;
+			setAccelSensitivity(0);
+			setAccelOffsets(0, 0, 0);
+			setAccelScales(ACCEL_UNITY_SCALE, ACCEL_UNITY_SCALE, ACCEL_UNITY_SCALE);
+		}
+
+		int16_t getRawAccelX(void)
+		{
+			// A calibration that never completes would read forever
+			if (++reads > 10 * READS_PER_POSE * ACCEL_POSE_COUNT)
+			{
+				printf("FAILED: calibration did not complete\n");
+				exit(1);
+			}
+
+			return raw(0);
+		}
+
+		int16_t getRawAccelY(void)
+		{
+			return raw(1);
+		}
+
+		int16_t getRawAccelZ(void)
+		{
+			return raw(2);
+		}
+
+		uint8_t setAccelSensitivity(uint8_t setting)
+		{
+			accelSensitivity = SENSITIVITY;
+			return setting;
+		}
+
+	private:
+		int16_t raw(uint8_t axis)
+		{
+			long pose = reads / READS_PER_POSE;
+			pose = pose < ACCEL_POSE_COUNT ? pose : ACCEL_POSE_COUNT - 1;
+
+			// Poses are X_UP, X_DOWN, Y_UP, Y_DOWN, Z_UP, Z_DOWN
+			double g = pose / 2 == axis ? (pose % 2 == 0 ? 1 : -1) : 0;
+			int noise = (int) (reads % 5) - 2;
+
+			return (int16_t) lround(gain[axis] * g * SENSITIVITY) + offset[axis] + noise;
+		}
+};
+
+int main(void)
+{
+	SimulatedAccelerometer accel;
+	accel.calcAccelCalibration();
+
+	check("x offset", abs(accel.getAccelXOffset() - accel.offset[0]) <= 2);
+	check("y offset", abs(accel.getAccelYOffset() - accel.offset[1]) <= 2);
+	check("z offset", abs(accel.getAccelZOffset() - accel.offset[2]) <= 2);
+	check("x scale", fabs(accel.getAccelXScale() - ACCEL_UNITY_SCALE / accel.gain[0]) <= 2);
+	check("y scale", fabs(accel.getAccelYScale() - ACCEL_UNITY_SCALE / accel.gain[1]) <= 2);
+	check("z scale", fabs(accel.getAccelZScale() - ACCEL_UNITY_SCALE / accel.gain[2]) <= 2);
+
+	// Gains up to 2 are accepted, so correctAccel can not overflow
+	int16_t poses[ACCEL_POSE_COUNT][3] = { { 8300, 0, 0 }, { -8300, 0, 0 }, { 0, 8300, 0 }, { 0, -8300, 0 }, { 0, 0, 8300 }, { 0, 0, -8300 } };
+	check("gain below 2 is accepted", accel.calcAccelScales(poses) == 0);
+
+	poses[1][0] = -8000;
+	check("gain above 2 is rejected", accel.calcAccelScales(poses) == 1);
+
+	poses[1][0] = 8300;
+	check("inverted axis is rejected", accel.calcAccelScales(poses) == 1);
+
+	printf(failures == 0 ? "All accelerometer tests passed.\n" : "%d accelerometer tests failed.\n", failures);
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,66 @@
+/*
+* MIT License
+*
+* Copyright (c) 2021 Robert Hutter
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+/*
+*	Arduino.h - The parts of the Arduino core the host tests need, so library
+*	sources compile and run on a PC.
+*/
+#ifndef _HOST_ARDUINO_H
+#define _HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+
+typedef uint8_t byte;
+
+#define DEC 10
+
+unsigned long micros(void);
+unsigned long millis(void);
+inline void noInterrupts(void) {}
+inline void interrupts(void) {}
+
+class String
+{
+	public:
+		String(const char* text = "") : text(text) {}
+
+	private:
+		std::string text;
+};
+
+class HardwareSerial
+{
+	public:
+		template <typename T> size_t print(T) { return 0; }
+		template <typename T> size_t print(T, int) { return 0; }
+		template <typename T> size_t println(T) { return 0; }
+		template <typename T> size_t println(T, int) { return 0; }
+};
+
+extern HardwareSerial Serial;
+
+#endif
@@ -0,0 +1,173 @@
+/*
+* MIT License
+*
+* Copyright (c) 2021 Robert Hutter
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+* EEPROM.cpp - Source code of EEPROM for Virtual Arduino runtime environment.
+*
+*/
+
+#include "EEPROM.h"
+#include <stdio.h>
+#include <string.h>
+
+vard::EEPROMMemory EEPROM;
+const char* vard::eeprom_path = EEPROM_DEFAULT_PATH;
+
+/**
+* Contructor for the class vard::EEPROMMemory.
+*
+*/
+vard::EEPROMMemory::EEPROMMemory(void)
+{
+
+}
+
+/**
+* Destructor for class vard::EEPROMMemory.
+*
+*/
+vard::EEPROMMemory::~EEPROMMemory(void)
+{
+
+}
+
+/**
+* Reads a byte from the EEPROM.
+*
+* @param addr Address to read from.
+* @return The byte at the address, 0xFF if the address is out of range.
+*/
+uint8_t vard::EEPROMMemory::read(int addr)
+{
+	if (addr < 0 || addr > E2END)
+	{
+		vard::logevent(Level::ERR, "EEPROM.read called. Address out of range. addr=%d", addr);
+		return 0xFF;
+	}
+
+	load();
+	return memory[addr];
+}
+
+/**
+* Writes a byte to the EEPROM.
+*
+* @param addr Address to write to.
+* @param val The byte to write.
+*/
+void vard::EEPROMMemory::write(int addr, uint8_t val)
+{
+	if (addr < 0 || addr > E2END)
+	{
+		vard::logevent(Level::ERR, "EEPROM.write called. Address out of range. addr=%d", addr);
+		return;
+	}
+
+	load();
+	memory[addr] = val;
+	store(addr);
+}
+
+/**
+* Writes a byte to the EEPROM only if it differs from the stored byte.
+*
+* @param addr Address to write to.
+* @param val The byte to write.
+*/
+void vard::EEPROMMemory::update(int addr, uint8_t val)
+{
+	if (read(addr) != val)
+	{
+		write(addr, val);
+	}
+}
+
+/**
+* Returns the size of the EEPROM in bytes.
+*
+*/
+uint16_t vard::EEPROMMemory::length(void)
+{
+	return E2END + 1;
+}
+
+/**
+* Loads the EEPROM's contents from the host file on first access.
+* Missing bytes read as 0xFF, like an erased EEPROM.
+*
+*/
+void vard::EEPROMMemory::load(void)
+{
+	if (isloaded)
+	{
+		return;
+	}
+
+	memset(memory, 0xFF, sizeof(memory));
+
+	FILE* file = NULL;
+	fopen_s(&file, eeprom_path, "rb");
+
+	if (file != NULL)
+	{
+		size_t len = fread(memory, 1, sizeof(memory), file);
+		fclose(file);
+		vard::logevent(Level::INFO, "EEPROM loaded. path=%s bytes=%u", eeprom_path, (unsigned int) len);
+	}
+	else
+	{
+		vard::logevent(Level::INFO, "EEPROM file not found, starting erased. path=%s", eeprom_path);
+	}
+
+	isloaded = true;
+}
+
+/**
+* Writes a single byte of the EEPROM through to the host file.
+*
+* @param addr Address of the byte.
+*/
+void vard::EEPROMMemory::store(int addr)
+{
+	FILE* file = NULL;
+	fopen_s(&file, eeprom_path, "r+b");
+
+	if (file == NULL)
+	{
+		// Create the file with the whole memory image
+		fopen_s(&file, eeprom_path, "wb");
+
+		if (file == NULL)
+		{
+			vard::logevent(Level::ERR, "EEPROM.write called. Cannot open file. path=%s", eeprom_path);
+			return;
+		}
+
+		fwrite(memory, 1, sizeof(memory), file);
+		fclose(file);
+		return;
+	}
+
+	fseek(file, addr, SEEK_SET);
+	fputc(memory[addr], file);
+	fclose(file);
+}
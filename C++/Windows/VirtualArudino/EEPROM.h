@@ -0,0 +1,64 @@
+/*
+* MIT License
+*
+* Copyright (c) 2021 Robert Hutter
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+* EEPROM.h - Header file of EEPROM source code. Part of Virtual Arduino runtime
+*	environment. The EEPROM's contents are kept in a file on the host.
+*
+*/
+
+#ifndef __EEPROM_H__
+#define __EEPROM_H__
+
+#include "VirtualArduino.h"
+
+/* EEPROM properties (ATmega328P) */
+#define E2END 0x3FF
+#define EEPROM_DEFAULT_PATH "eeprom.bin"
+
+namespace vard
+{
+	class EEPROMMemory
+	{
+	public:
+		EEPROMMemory(void);
+		~EEPROMMemory(void);
+
+		uint8_t read(int);
+		void write(int, uint8_t);
+		void update(int, uint8_t);
+		uint16_t length(void);
+
+	private:
+		bool isloaded = false;
+		uint8_t memory[E2END + 1];
+
+		void load(void);
+		void store(int);
+	};
+
+	extern const char* eeprom_path;
+}
+
+extern vard::EEPROMMemory EEPROM;
+
+#endif
@@ -49,9 +49,13 @@
 // __AVR_ATmega2560__ , __SAM3X8E__
 
 #define PI ((double) 3.141592654)
+#define SERIAL_TX_BUFFER_SIZE 64
 
 typedef uint8_t byte;
 
+#define lowByte(w) ((uint8_t) ((w) & 0xff))
+#define highByte(w) ((uint8_t) ((w) >> 8))
+
 enum PinModes { INPUT, OUTPUT, INPUT_PULLUP };
 enum OutputLevel { LOW, HIGH };
 enum class InterruptMode { LOW, CHANGE, RISING, FALLING }; // This will cause issues in the future with sketches using interrupts.
@@ -166,10 +170,12 @@ namespace vard
 		void write(uint8_t);
 		void write(uint8_t*, unsigned int);
 		uint8_t read(void);
+		int peek(void);
 		void readBytes(uint8_t*, unsigned int);
 		String readString(void);
 
 		unsigned int available(void);
+		int availableForWrite(void);
 		void setTimeout(unsigned long);
 
 	private:
@@ -890,6 +890,28 @@ uint8_t vard::HardwareSerial::read(void)
 	return 0;
 }
 
+/**
+* Returns the next byte in the incomming byte buffer
+* without removing it.
+* 
+* @return The byte, or -1 if the buffer is empty.
+*/
+int vard::HardwareSerial::peek(void)
+{
+	if (this->isconnected)
+	{
+		if (this->pos < this->buffsize)
+		{
+			return this->readbuffer[pos];
+		}
+
+		return -1;
+	}
+
+	vard::logevent(vard::Level::ERR, "Serial.peek called. Port not open.");
+	return -1;
+}
+
 /**
 * Read bytes from incomming byte buffer.
 * 
@@ -952,6 +974,17 @@ unsigned int vard::HardwareSerial::available(void)
 	return this->buffsize - this->pos;
 }
 
+/**
+* Returns the free space of the outgoing byte buffer. Bytes
+* are written out immediately, so the buffer is always empty.
+* 
+* @return
+*/
+int vard::HardwareSerial::availableForWrite(void)
+{
+	return SERIAL_TX_BUFFER_SIZE - 1;
+}
+
 /**
 * Set the timeout of the serial connection.
 *
@@ -46,6 +46,7 @@ namespace SRL
 
       void update(unsigned int sampleSize = 1);
       void update(unsigned long deltaT, unsigned int sampleSize = 1);
+      void sample(void);
 
       /* Getters & setters */
       float getAccelCoeff(void);
@@ -59,11 +60,22 @@ namespace SRL
       void setAngleX(float angle);
       void setAngleY(float angle);
       void setAngleZ(float angle);
+      unsigned long getLastUpdate(void);
+
+      /* Calibration storage */
+      uint8_t getCalibrationSize(void);
+      void saveCalibration(byte* data);
+      void loadCalibration(const byte* data);
 
     protected:
       float aC;
       float gC;
       Angle angleX, angleY, angleZ;
+
+      Axes prevGyro;
+      unsigned long lastUpdate;
+
+      void fuse(Axes gyro, Axes accel, unsigned long deltaT);
   };
 }
 
@@ -27,8 +27,13 @@
 #include "SRL.h"
 #include "Component.h"
 #include "Statistics.h"
+#include "Sample.h"
 
 #define ACCEL_CALIBRATION_I 25
+#define ACCEL_SCALE_SHIFT 14
+#define ACCEL_UNITY_SCALE (1 << ACCEL_SCALE_SHIFT)
+#define ACCEL_POSE_COUNT 6
+#define ACCEL_CALIBRATION_SIZE 12
 
 namespace SRL
 {
@@ -52,6 +57,10 @@ namespace SRL
       double getAccelYMedian(unsigned int iterations = 5);
       double getAccelZMedian(unsigned int iterations = 5);
 
+      Sample<Axes> sampleAccel(unsigned int iterations = 1);
+      Sample<Axes> getAccelSample(void);
+      void sample(void);
+
       int16_t getAccelXOffset(void);
       void setAccelXOffset(int16_t offset);
       int16_t getAccelYOffset(void);
@@ -65,6 +74,25 @@ namespace SRL
 
       void calcAccelOffsets(uint8_t orientation = Y_UP, bool console = false, unsigned int iterations = 50);
 
+      /* Six-position calibration */
+      uint16_t getAccelXScale(void);
+      void setAccelXScale(uint16_t scale);
+      uint16_t getAccelYScale(void);
+      void setAccelYScale(uint16_t scale);
+      uint16_t getAccelZScale(void);
+      void setAccelZScale(uint16_t scale);
+
+      void setAccelScales(uint16_t x, uint16_t y, uint16_t z);
+
+      void getRawAccelAverage(int16_t* x, int16_t* y, int16_t* z, unsigned int samples = ACCEL_CALIBRATION_I);
+      uint8_t calcAccelScales(int16_t poses[ACCEL_POSE_COUNT][3]);
+      void calcAccelCalibration(bool console = false, unsigned int iterations = 20);
+
+      /* Calibration storage */
+      uint8_t getCalibrationSize(void);
+      void saveCalibration(byte* data);
+      void loadCalibration(const byte* data);
+
       enum Orientation
       {
         X_UP = 1,
@@ -81,6 +109,16 @@ namespace SRL
       int16_t accelXOffset;
       int16_t accelYOffset;
       int16_t accelZOffset;
+
+      /* Per-axis gain in ACCEL_SCALE_SHIFT fixed point */
+      uint16_t accelXScale;
+      uint16_t accelYScale;
+      uint16_t accelZScale;
+
+      Sample<Axes> accelSample;
+
+      int32_t correctAccel(int16_t raw, int16_t offset, uint16_t scale);
+      uint8_t detectAccelPose(int16_t x, int16_t y, int16_t z);
   };
 }
 
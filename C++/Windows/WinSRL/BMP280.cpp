@@ -124,18 +124,21 @@ uint8_t SRL::BMP280::setMode(byte value)
 }
 
 /**
-*	Returns the latest pressure reading.
+*	Returns the latest pressure reading. The temperature needed for the
+*	compensation is read in the same transaction and recorded.
 *
 *	@return The latest pressure reading in Pa.
 */
 double SRL::BMP280::getPressure(void)
 {
-	// Get uncalculated pressure measurements
-	byte pbuffer[3];
-	readBytes(BMP280_PRESS, pbuffer, 3);
+	// Get uncalculated pressure and temperature measurements in one read
+	byte pbuffer[6];
+	readBytes(BMP280_PRESS, pbuffer, 6);
 
 	double press = (double)(pbuffer[0] * 4096 + pbuffer[1] * 16 + pbuffer[2] / 16);
-	double temp = getTemperature() * 5120.0;
+	double temp = compensateTemperature(pbuffer + 3);
+	recordTemperature(temp, micros());
+	temp *= 5120.0;
 	
 	double var1 = (temp / 2.0) - 64000.0;
 	double var2 = var1 * var1 * dig_P6 / 32768.0;
@@ -167,6 +170,20 @@ double SRL::BMP280::getTemperature(void)
 	byte tbuffer[3];
 	readBytes(BMP280_TEMP, tbuffer, 3);
 	
+	double temp = compensateTemperature(tbuffer);
+	recordTemperature(temp, micros());
+
+	return temp;
+}
+
+/**
+*	Converts a raw temperature measurement with the compensation coefficients.
+*
+*	@param tbuffer The three bytes read from BMP280_TEMP.
+*	@return The temperature in Celcius.
+*/
+double SRL::BMP280::compensateTemperature(byte* tbuffer)
+{
 	double temp = (double)(tbuffer[0] * 4096 + tbuffer[1] * 16 + tbuffer[2] / 16);
 	
 	double var1 = (temp / 16384.0 - dig_T1 / 1024.0) * dig_T2;
@@ -274,3 +291,91 @@ void SRL::BMP280::calibrateBasePressure(unsigned int samples)
 {
 	basePressure = getMedianPressure(samples) / 10;
 }
+
+/**
+*	Returns the size of the BMP280's calibration data in bytes.
+*
+*/
+uint8_t SRL::BMP280::getCalibrationSize(void)
+{
+	return BMP280_CALIBRATION_SIZE;
+}
+
+/**
+*	Writes the base pressure and the compensation coefficients to a buffer.
+*
+*	@param data The buffer of BMP280_CALIBRATION_SIZE bytes.
+*/
+void SRL::BMP280::saveCalibration(byte* data)
+{
+	float base = basePressure;
+	unsigned short dig[12] = {
+		dig_T1, (unsigned short) dig_T2, (unsigned short) dig_T3,
+		dig_P1, (unsigned short) dig_P2, (unsigned short) dig_P3,
+		(unsigned short) dig_P4, (unsigned short) dig_P5, (unsigned short) dig_P6,
+		(unsigned short) dig_P7, (unsigned short) dig_P8, (unsigned short) dig_P9
+	};
+
+	memcpy(data, &base, sizeof(base));
+	memcpy(data + sizeof(base), dig, sizeof(dig));
+}
+
+/**
+*	Restores the base pressure and the compensation coefficients from a buffer.
+*	Call after initialize(), which reads the coefficients from the device.
+*
+*	@param data The buffer of BMP280_CALIBRATION_SIZE bytes.
+*/
+void SRL::BMP280::loadCalibration(const byte* data)
+{
+	float base;
+	unsigned short dig[12];
+
+	memcpy(&base, data, sizeof(base));
+	memcpy(dig, data + sizeof(base), sizeof(dig));
+
+	basePressure = base;
+	dig_T1 = dig[0];
+	dig_T2 = (signed short) dig[1];
+	dig_T3 = (signed short) dig[2];
+	dig_P1 = dig[3];
+	dig_P2 = (signed short) dig[4];
+	dig_P3 = (signed short) dig[5];
+	dig_P4 = (signed short) dig[6];
+	dig_P5 = (signed short) dig[7];
+	dig_P6 = (signed short) dig[8];
+	dig_P7 = (signed short) dig[9];
+	dig_P8 = (signed short) dig[10];
+	dig_P9 = (signed short) dig[11];
+}
+
+/**
+*	Reads the pressure (in Pa) and stamps it with the time in the middle of
+*	the read. The sample is kept for getPressureSample().
+*
+*/
+SRL::Sample<double> SRL::BMP280::samplePressure(void)
+{
+	unsigned long start = micros();
+	double pressure = getPressure();
+
+	pressureSample = Sample<double>(pressure, start + (micros() - start) / 2);
+	return pressureSample;
+}
+
+/**
+*	Returns the last sample taken by samplePressure() without reading the sensor.
+*
+*/
+SRL::Sample<double> SRL::BMP280::getPressureSample(void)
+{
+	return pressureSample;
+}
+
+/**
+*	Takes a sample of the pressure. Used by SensorHub.
+*/
+void SRL::BMP280::sample(void)
+{
+	samplePressure();
+}
@@ -0,0 +1,320 @@
+/*
+* MIT License
+*
+* Copyright (c) 2018 Robert Hutter
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+#include "CommandTable.h"
+
+/**
+*	Returns the number of arguments.
+*
+*/
+uint8_t SRL::Arguments::getCount(void)
+{
+	return count;
+}
+
+/**
+*	Parses an integer argument in place.
+*
+*	@param index The argument's index.
+*	@param fallback Returned if there is no such argument or it is not an integer.
+*/
+long SRL::Arguments::getInt(uint8_t index, long fallback)
+{
+	if (index >= count || length[index] == 0)
+	{
+		return fallback;
+	}
+
+	// The argument ends at ',' or ')', which strtol() stops at
+	char* end;
+	long value = strtol(data[index], &end, 10);
+
+	return end == data[index] + length[index] ? value : fallback;
+}
+
+/**
+*	Parses a floating point argument in place.
+*
+*	@param index The argument's index.
+*	@param fallback Returned if there is no such argument or it is not a number.
+*/
+double SRL::Arguments::getFloat(uint8_t index, double fallback)
+{
+	if (index >= count || length[index] == 0)
+	{
+		return fallback;
+	}
+
+	char* end;
+	double value = strtod(data[index], &end);
+
+	return end == data[index] + length[index] ? value : fallback;
+}
+
+/**
+*	Returns a view of an argument's text, its data is NULL if there is no
+*	such argument.
+*
+*	@param index The argument's index.
+*/
+SRL::Payload SRL::Arguments::getText(uint8_t index)
+{
+	Payload text = { NULL, 0 };
+
+	if (index < count)
+	{
+		text.data = (const byte*) data[index];
+		text.length = length[index];
+	}
+
+	return text;
+}
+
+/**
+*	Constructor for an empty command table.
+*
+*/
+SRL::CommandTable::CommandTable(void)
+{
+	clear();
+}
+
+/**
+*	Adds a command, or replaces the handler of a command already added.
+*
+*	@param name The command's name. Not copied, so it has to stay valid.
+*	@param function The function handling the command.
+*	@param context Passed to the function.
+*	@return Returns 0 on success, 1 if the table is full.
+*/
+uint8_t SRL::CommandTable::add(const char* name, SRL::CommandFunction function, void* context)
+{
+	uint8_t len = strlen(name);
+	int8_t i = find(name, len);
+
+	if (i < 0)
+	{
+		uint16_t h = hash(name, len);
+
+		// Take the first empty or removed slot of the name's probe sequence
+		for (uint8_t probe = 0; probe < COMMAND_TABLE_SIZE; probe++)
+		{
+			uint8_t slot = (h + probe) & (COMMAND_TABLE_SIZE - 1);
+
+			if (entries[slot].function == NULL)
+			{
+				i = slot;
+				break;
+			}
+		}
+
+		if (i < 0)
+		{
+			return 1;
+		}
+
+		count++;
+	}
+
+	entries[i].name = name;
+	entries[i].hash = hash(name, len);
+	entries[i].function = function;
+	entries[i].context = context;
+
+	return 0;
+}
+
+/**
+*	Removes a command.
+*
+*	@param name The command's name.
+*	@return Returns 0 on success, 1 if there is no such command.
+*/
+uint8_t SRL::CommandTable::remove(const char* name)
+{
+	int8_t i = find(name, strlen(name));
+
+	if (i < 0)
+	{
+		return 1;
+	}
+
+	// The name stays, so the probe sequences running through the slot still do
+	entries[i].function = NULL;
+	entries[i].context = NULL;
+	count--;
+
+	return 0;
+}
+
+/**
+*	Removes all commands.
+*
+*/
+void SRL::CommandTable::clear(void)
+{
+	for (uint8_t i = 0; i < COMMAND_TABLE_SIZE; i++)
+	{
+		entries[i].name = NULL;
+		entries[i].hash = 0;
+		entries[i].function = NULL;
+		entries[i].context = NULL;
+	}
+
+	count = 0;
+}
+
+/**
+*	Calls the handler of a received command.
+*
+*	@param command The command, e.g. from Slave::readPayload().
+*	@return Returns 0 if the command was handled, 1 if it is unknown or malformed.
+*/
+uint8_t SRL::CommandTable::dispatch(SRL::Payload command)
+{
+	return dispatch((const char*) command.data, command.length);
+}
+
+/**
+*	Calls the handler of a command of the form name(a,b,c); The arguments
+*	are found in place and passed to the handler as views.
+*
+*	@param command The command's text, need not end with '\0'.
+*	@param length The command's length.
+*	@return Returns 0 if the command was handled, 1 if it is unknown or malformed.
+*/
+uint8_t SRL::CommandTable::dispatch(const char* command, uint8_t length)
+{
+	if (command == NULL)
+	{
+		return 1;
+	}
+
+	uint8_t i = 0;
+	while (i < length && command[i] != '(' && command[i] != ';')
+	{
+		i++;
+	}
+
+	int8_t entry = find(command, i);
+	if (entry < 0)
+	{
+		return 1;
+	}
+
+	Arguments args;
+	args.count = 0;
+
+	if (i < length && command[i] == '(')
+	{
+		uint8_t start = ++i;
+
+		for (; i < length && command[i] != ')'; i++)
+		{
+			if (command[i] == ',')
+			{
+				if (args.count == COMMAND_MAX_ARGUMENTS)
+				{
+					return 1;
+				}
+
+				args.data[args.count] = command + start;
+				args.length[args.count++] = i - start;
+				start = i + 1;
+			}
+		}
+
+		if (i == length || args.count == COMMAND_MAX_ARGUMENTS)
+		{
+			return 1;
+		}
+
+		// name() has no arguments, name(,) has two empty ones
+		if (i > start || args.count > 0)
+		{
+			args.data[args.count] = command + start;
+			args.length[args.count++] = i - start;
+		}
+	}
+
+	entries[entry].function(entries[entry].context, args);
+	return 0;
+}
+
+/**
+*	Returns the number of commands in the table.
+*
+*/
+uint8_t SRL::CommandTable::getCount(void)
+{
+	return count;
+}
+
+/**
+*	Hashes a command's name, FNV-1a folded to 16 bits.
+*
+*	@param name The name.
+*	@param length The name's length.
+*/
+uint16_t SRL::CommandTable::hash(const char* name, uint8_t length)
+{
+	uint32_t h = 2166136261UL;
+
+	for (uint8_t i = 0; i < length; i++)
+	{
+		h ^= (uint8_t) name[i];
+		h *= 16777619UL;
+	}
+
+	return (h >> 16) ^ (h & 0xFFFF);
+}
+
+/**
+*	Returns the slot of a command, -1 if it is not in the table.
+*
+*	@param name The command's name, need not end with '\0'.
+*	@param length The name's length.
+*/
+int8_t SRL::CommandTable::find(const char* name, uint8_t length)
+{
+	uint16_t h = hash(name, length);
+
+	for (uint8_t probe = 0; probe < COMMAND_TABLE_SIZE; probe++)
+	{
+		Entry* entry = &entries[(h + probe) & (COMMAND_TABLE_SIZE - 1)];
+
+		// Empty slots end the probe sequence, removed ones do not
+		if (entry->name == NULL)
+		{
+			return -1;
+		}
+
+		if (entry->function != NULL && entry->hash == h
+			&& strncmp(entry->name, name, length) == 0 && entry->name[length] == '\0')
+		{
+			return entry - entries;
+		}
+	}
+
+	return -1;
+}
@@ -47,6 +47,15 @@ void SRL::Component::initialize(void)
   /* Override me */
 }
 
+/**
+* Takes a sample of the component's readings and keeps it for its
+* get*Sample getters. Used by SensorHub.
+*/
+void SRL::Component::sample(void)
+{
+  /* Override me */
+}
+
 String SRL::Component::getName(void)
 {
   return name;
@@ -56,3 +65,39 @@ unsigned int SRL::Component::getId(void)
 {
   return id;
 }
+
+unsigned int SRL::Component::getType(void)
+{
+  return type;
+}
+
+/**
+* Returns the number of bytes saveCalibration writes.
+* Components without calibration data return 0.
+*/
+uint8_t SRL::Component::getCalibrationSize(void)
+{
+  return 0;
+}
+
+/**
+* Writes the component's calibration data to a buffer of
+* getCalibrationSize() bytes.
+*
+* @param data The buffer to write to.
+*/
+void SRL::Component::saveCalibration(byte* /* data */)
+{
+  /* Override me */
+}
+
+/**
+* Restores the component's calibration data from a buffer written
+* by saveCalibration.
+*
+* @param data The buffer to read from.
+*/
+void SRL::Component::loadCalibration(const byte* /* data */)
+{
+  /* Override me */
+}
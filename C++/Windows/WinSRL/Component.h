@@ -35,12 +35,18 @@ namespace SRL
       Component(String name, unsigned int type);
 
       void initialize(void);
+      virtual void sample(void);
 
       /* Getters & setters: */
       unsigned int getId(void);
       String getName(void);
       unsigned int getType(void);
 
+      /* Calibration */
+      virtual uint8_t getCalibrationSize(void);
+      virtual void saveCalibration(byte* data);
+      virtual void loadCalibration(const byte* data);
+
       /* Static variables */
       static unsigned int lastId;
 
@@ -0,0 +1,121 @@
+/*
+* MIT License
+*
+* Copyright (c) 2018 Robert Hutter
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+#ifndef _EXECUTIVE_H
+#define _EXECUTIVE_H
+
+#include "SRL.h"
+
+#define EXECUTIVE_MAX_TASKS 8
+#define EXECUTIVE_TICK 500 // us, every task period is a multiple of this
+
+// On AVR the executive can be driven by timer 1, see below
+#if defined(__AVR__) && defined(TIMSK1)
+#define EXECUTIVE_TIMER1
+#define EXECUTIVE_TIMER_TOP (F_CPU / 8 / (1000000UL / EXECUTIVE_TICK) - 1)
+#endif
+
+namespace SRL
+{
+	typedef void (*TaskFunction)(void* context);
+
+	/**
+	*	Class Executive. Runs periodic tasks from one hardware timer interrupt.
+	*	The timer fires every EXECUTIVE_TICK micro seconds and releases the
+	*	tasks that are due, so their rates do not depend on loop(). Tasks run
+	*	highest priority first with interrupts enabled: a task released while
+	*	a lower priority task runs preempts it, and encoder interrupts are
+	*	never blocked by a task. Every task has overrun, jitter and duration
+	*	counters.
+	*
+	*	Nothing runs until the sketch calls begin(). On AVR the sketch can
+	*	hand timer 1 to the executive by defining EXECUTIVE_USE_TIMER1 before
+	*	including this header, in one file only. Timer 1's PWM pins (9 and 10
+	*	on an Uno, 11 and 12 on a Mega) then can not drive motors, and the
+	*	Servo library can not be used. Otherwise tick() has to be called from
+	*	a timer interrupt every EXECUTIVE_TICK micro seconds.
+	*/
+	class Executive
+	{
+		public:
+			static int8_t add(SRL::TaskFunction function, void* context, unsigned long period, uint8_t priority);
+			static uint8_t remove(SRL::TaskFunction function, void* context);
+			static int8_t find(SRL::TaskFunction function, void* context);
+
+			static void begin(void);
+			static void end(void);
+			static void tick(void);
+			static void resetCounters(void);
+			static bool attachTimer1(void);
+
+			/* Getters & setters */
+			static bool isRunning(void);
+			static uint8_t getCount(void);
+			static unsigned long getTicks(void);
+
+			static unsigned long getPeriod(uint8_t index);
+			static uint8_t getPriority(uint8_t index);
+			static unsigned long getRuns(uint8_t index);
+			static unsigned int getOverruns(uint8_t index);
+			static unsigned long getMaxJitter(uint8_t index);
+			static unsigned long getMaxDuration(uint8_t index);
+
+		private:
+			typedef struct
+			{
+				SRL::TaskFunction function;
+				void* context;
+				unsigned int period;
+				unsigned int countdown;
+				uint8_t priority;
+				bool pending;
+				bool running;
+				unsigned long release;
+				unsigned long runs;
+				unsigned int overruns;
+				unsigned long maxJitter;
+				unsigned long maxDuration;
+			} Task;
+
+			static Task tasks[EXECUTIVE_MAX_TASKS];
+			static uint8_t count;
+			static unsigned int level;
+			static unsigned long ticks;
+			static bool running;
+			static bool timer1;
+
+			static void dispatch(void);
+	};
+}
+
+#if defined(EXECUTIVE_TIMER1) && defined(EXECUTIVE_USE_TIMER1)
+ISR(TIMER1_COMPA_vect)
+{
+	SRL::Executive::tick();
+}
+
+// Global constructors run before setup(), so begin() knows the vector is there
+static bool executiveTimer1 = SRL::Executive::attachTimer1();
+#endif
+
+#endif
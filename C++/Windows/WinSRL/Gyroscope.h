@@ -27,14 +27,27 @@
 #include "SRL.h"
 #include "Component.h"
 #include "Statistics.h"
+#include "Sample.h"
+#include "Thermometer.h"
 
 #define GYRO_CALIBRATION_I 25
+#define GYRO_CALIBRATION_SIZE 46
+#define GYRO_STILL_THRESHOLD 20
+#define GYRO_BIAS_LINEAR_SPAN 2.0
+#define GYRO_BIAS_QUADRATIC_SPAN 10.0
 
 namespace SRL
 {
+  /**
+  * Class Gyroscope. The zero rate bias of each axis is the offset plus a
+  * polynomial of the die temperature, which learnGyroBias() fits to readings
+  * taken while the sensor stands still.
+  */
   class Gyroscope : virtual public SRL::Component
   {
     public:
+      Gyroscope(void);
+
       virtual int16_t getRawGyroX(void) = 0;
 			virtual int16_t getRawGyroY(void) = 0;
 			virtual int16_t getRawGyroZ(void) = 0;
@@ -51,6 +64,10 @@ namespace SRL
       double getGyroYMedian(unsigned int iterations = 5);
       double getGyroZMedian(unsigned int iterations = 5);
 
+      Sample<Axes> sampleGyro(unsigned int iterations = 1);
+      Sample<Axes> getGyroSample(void);
+      void sample(void);
+
       /* Getters & setters */
       int16_t getGyroXOffset(void);
 			void setGyroXOffset(int16_t offset);
@@ -62,14 +79,51 @@ namespace SRL
       void setGyroOffsets(int16_t x, int16_t y, int16_t z);
       void calcGyroOffsets(bool console = false, unsigned int interations = 50);
 
+      /* Temperature compensation */
+      uint8_t learnGyroBias(int16_t threshold = GYRO_STILL_THRESHOLD);
+      void resetGyroBias(void);
+
+      double getGyroXBias(void);
+      double getGyroYBias(void);
+      double getGyroZBias(void);
+
+      Thermometer* getGyroThermometer(void);
+      void setGyroThermometer(Thermometer* thermometer);
+      float getGyroBiasTemp(void);
+      uint8_t getGyroBiasOrder(void);
+      unsigned int getGyroBiasPoints(void);
+
       virtual uint8_t setGyroSensitivity(uint8_t setting) = 0;
 
+      /* Calibration storage */
+      uint8_t getCalibrationSize(void);
+      void saveCalibration(byte* data);
+      void loadCalibration(const byte* data);
+
     protected:
       int16_t gyroXOffset;
 			int16_t gyroYOffset;
 			int16_t gyroZOffset;
 
       double gyroSensitivity;
+
+      double getGyroBias(int16_t offset, uint8_t axis);
+      float getGyroTemp(void);
+      void fitGyroBias(void);
+      void clearGyroBiasSums(void);
+
+      Thermometer* gyroThermometer;
+      float gyroBiasTemp;
+      float gyroBias[3][3];
+      uint8_t gyroBiasOrder;
+
+      // Least squares sums of the stationary readings
+      float gyroTempSums[5];
+      float gyroBiasSums[3][3];
+      float gyroMinTemp;
+      float gyroMaxTemp;
+
+      Sample<Axes> gyroSample;
   };
 }
 
@@ -38,3 +38,48 @@ double SRL::JGY370::convertCm(long steps)
 {
   return ((double) steps) / CM_IN_STEPS;
 }
+
+/**
+* Sets the motor's direction and the duty cycle the speed map gives for a
+* speed, without feedback.
+*
+* @param velocity The speed in steps/s, negative is backwards.
+*/
+void SRL::JGY370::setVelocity(long velocity)
+{
+  setDirection((velocity >= 0) ? Motor::FORWARD : Motor::BACKWARD);
+  setDuty(speedMap.getDuty(labs(velocity)));
+}
+
+SRL::SpeedMap* SRL::JGY370::getSpeedMap(void)
+{
+  return &speedMap;
+}
+
+/**
+* Returns the size of the speed map.
+*/
+uint8_t SRL::JGY370::getCalibrationSize(void)
+{
+  return speedMap.getCalibrationSize();
+}
+
+/**
+* Writes the speed map to a buffer.
+*
+* @param data The buffer of getCalibrationSize() bytes.
+*/
+void SRL::JGY370::saveCalibration(byte* data)
+{
+  speedMap.saveCalibration(data);
+}
+
+/**
+* Restores the speed map from a buffer.
+*
+* @param data The buffer of getCalibrationSize() bytes.
+*/
+void SRL::JGY370::loadCalibration(const byte* data)
+{
+  speedMap.loadCalibration(data);
+}
@@ -27,6 +27,7 @@
 #include "SRL.h"
 #include "Encoder.h"
 #include "Motor.h"
+#include "SpeedMap.h"
 
 #define JGY370_COMPONENT_NAME "JGY370"
 #define STEP_IN_CM 0.00085
@@ -34,6 +35,11 @@
 
 namespace SRL
 {
+  /**
+  * Class JGY370. A gearmotor with an encoder. It keeps a speed map of the
+  * motor, which a SpeedController learns and looks its feedforward up in,
+  * and which is stored with the calibration data.
+  */
   class JGY370 : public SRL::Encoder, public SRL::Motor
   {
     public:
@@ -41,6 +47,17 @@ namespace SRL
 
       long convertSteps(double cm);
       double convertCm(long steps);
+
+      void setVelocity(long velocity);
+      SRL::SpeedMap* getSpeedMap(void);
+
+      /* Calibration storage */
+      uint8_t getCalibrationSize(void);
+      void saveCalibration(byte* data);
+      void loadCalibration(const byte* data);
+
+    private:
+      SRL::SpeedMap speedMap;
   };
 }
 
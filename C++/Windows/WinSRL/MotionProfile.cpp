@@ -0,0 +1,266 @@
+/*
+* MIT License
+*
+* Copyright (c) 2021 Robert Hutter
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+#include "MotionProfile.h"
+
+/**
+*	Constructor of class MotionProfile.
+*
+*	@param maxVelocity The largest velocity of a move.
+*	@param maxAcceleration The largest acceleration and deceleration of a move.
+*	@param maxJerk The largest change of acceleration per second, 0 for no limit.
+*/
+SRL::MotionProfile::MotionProfile(double maxVelocity, double maxAcceleration, double maxJerk)
+{
+	setLimits(maxVelocity, maxAcceleration, maxJerk);
+	distance = 0;
+	sign = 1;
+	stop();
+}
+
+/**
+*	Starts a new move from standing still.
+*
+*	@param distance The length of the move, negative moves backwards.
+*/
+void SRL::MotionProfile::start(double distance)
+{
+	this->sign = (distance < 0) ? -1 : 1;
+	this->distance = distance * sign;
+	position = 0;
+	velocity = 0;
+	acceleration = 0;
+	finished = (this->distance == 0);
+}
+
+/**
+*	Advances the profile by one control tick.
+*	Without a jerk limit the velocity is kept below the speed the rest of the
+*	move can still be stopped from, sqrt(2 * a * remaining). With a jerk
+*	limit the acceleration is ramped up or down by the jerk limit, depending
+*	on whether the move could still be stopped within the remaining distance.
+*
+*	@param deltaT The length of the tick in seconds.
+*	@return The velocity setpoint of the tick.
+*/
+double SRL::MotionProfile::update(double deltaT)
+{
+	if (finished || deltaT <= 0)
+	{
+		return velocity * sign;
+	}
+
+	double remaining = distance - position;
+
+	if (maxJerk > 0)
+	{
+		double step = maxJerk * deltaT;
+
+		if (getStoppingDistance() >= remaining)
+		{
+			// Brake, easing out of the deceleration as the velocity reaches 0
+			if (acceleration < 0 && velocity <= acceleration * acceleration / (2 * maxJerk))
+			{
+				acceleration = (acceleration + step < 0) ? acceleration + step : 0;
+			}
+			else
+			{
+				acceleration = (acceleration - step > -maxAcceleration) ? acceleration - step : -maxAcceleration;
+			}
+		}
+		else if (velocity + acceleration * fabs(acceleration) / (2 * maxJerk) < maxVelocity)
+		{
+			acceleration = (acceleration + step < maxAcceleration) ? acceleration + step : maxAcceleration;
+		}
+		else
+		{
+			// Ease into the cruise velocity
+			acceleration = (fabs(acceleration) > step) ? acceleration - step * (acceleration > 0 ? 1 : -1) : 0;
+		}
+	}
+	else
+	{
+		double target = sqrt(2 * maxAcceleration * remaining);
+		if (target > maxVelocity)
+		{
+			target = maxVelocity;
+		}
+
+		acceleration = (target - velocity) / deltaT;
+		if (acceleration > maxAcceleration)
+		{
+			acceleration = maxAcceleration;
+		}
+		else if (acceleration < -maxAcceleration)
+		{
+			acceleration = -maxAcceleration;
+		}
+	}
+
+	velocity += acceleration * deltaT;
+	if (velocity > maxVelocity)
+	{
+		velocity = maxVelocity;
+	}
+	else if (velocity < 0)
+	{
+		velocity = 0;
+	}
+
+	position += velocity * deltaT;
+
+	// Arrived, or stopped so close to the goal that it is reached within a tick
+	if (position >= distance || (velocity == 0 && remaining <= maxAcceleration * deltaT * deltaT))
+	{
+		stop();
+		position = distance;
+	}
+
+	return velocity * sign;
+}
+
+/**
+*	Returns the distance needed to stop from the current velocity and
+*	acceleration: the acceleration is ramped down to the deceleration peak,
+*	held, then ramped back up to 0 as the velocity reaches 0.
+*/
+double SRL::MotionProfile::getStoppingDistance(void)
+{
+	double j = maxJerk;
+	double a = acceleration;
+	double v = velocity;
+
+	// Peak deceleration, lower if the velocity is reached before the limit
+	double peak = sqrt(j * v + a * a / 2);
+	if (peak > maxAcceleration)
+	{
+		peak = maxAcceleration;
+	}
+	if (peak < -a)
+	{
+		peak = -a;
+	}
+
+	double t1 = (a + peak) / j;
+	double t3 = peak / j;
+	double t2 = (v + (a * a - peak * peak) / (2 * j) - peak * t3 + peak * peak / (2 * j)) / peak;
+	if (!(t2 > 0))
+	{
+		t2 = 0;
+	}
+
+	double d = v * t1 + a * t1 * t1 / 2 - j * t1 * t1 * t1 / 6;
+	v += a * t1 - j * t1 * t1 / 2;
+	d += v * t2 - peak * t2 * t2 / 2;
+	v -= peak * t2;
+	d += v * t3 - peak * t3 * t3 / 2 + j * t3 * t3 * t3 / 6;
+
+	return d;
+}
+
+/**
+*	Ends the move immediately.
+*/
+void SRL::MotionProfile::stop(void)
+{
+	velocity = 0;
+	acceleration = 0;
+	finished = true;
+}
+
+/**
+*	Returns true if the move has ended.
+*/
+bool SRL::MotionProfile::isFinished(void)
+{
+	return finished;
+}
+
+/**
+*	Returns the length of the current move.
+*/
+double SRL::MotionProfile::getDistance(void)
+{
+	return distance * sign;
+}
+
+/**
+*	Returns the distance covered by the setpoints so far.
+*/
+double SRL::MotionProfile::getPosition(void)
+{
+	return position * sign;
+}
+
+/**
+*	Returns the velocity setpoint of the last tick.
+*/
+double SRL::MotionProfile::getVelocity(void)
+{
+	return velocity * sign;
+}
+
+/**
+*	Returns the acceleration of the last tick.
+*/
+double SRL::MotionProfile::getAcceleration(void)
+{
+	return acceleration * sign;
+}
+
+/**
+*	Returns the distance left of the move.
+*/
+double SRL::MotionProfile::getRemaining(void)
+{
+	return (distance - position) * sign;
+}
+
+/**
+*	Sets the limits of the profile. They apply from the next tick.
+*
+*	@param maxVelocity The largest velocity of a move.
+*	@param maxAcceleration The largest acceleration and deceleration of a move.
+*	@param maxJerk The largest change of acceleration per second, 0 for no limit.
+*/
+void SRL::MotionProfile::setLimits(double maxVelocity, double maxAcceleration, double maxJerk)
+{
+	this->maxVelocity = fabs(maxVelocity);
+	this->maxAcceleration = fabs(maxAcceleration);
+	this->maxJerk = fabs(maxJerk);
+}
+
+double SRL::MotionProfile::getMaxVelocity(void)
+{
+	return maxVelocity;
+}
+
+double SRL::MotionProfile::getMaxAcceleration(void)
+{
+	return maxAcceleration;
+}
+
+double SRL::MotionProfile::getMaxJerk(void)
+{
+	return maxJerk;
+}
@@ -0,0 +1,77 @@
+/*
+* MIT License
+*
+* Copyright (c) 2021 Robert Hutter
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+#ifndef _MOTIONPROFILE_H
+#define _MOTIONPROFILE_H
+
+#include "SRL.h"
+
+namespace SRL
+{
+	/**
+	*	Class MotionProfile. Generates the velocity setpoints of a move of a
+	*	given distance, limited in velocity, acceleration and jerk. With a jerk
+	*	limit of 0 the profile is trapezoidal, otherwise it is an S-curve.
+	*	The profile is evaluated one control tick at a time by update().
+	*	Units are up to the user, e.g. cm, cm/s, cm/s^2 and cm/s^3.
+	*/
+	class MotionProfile
+	{
+		public:
+			MotionProfile(double maxVelocity = 1.0, double maxAcceleration = 1.0, double maxJerk = 0.0);
+
+			void start(double distance);
+			double update(double deltaT);
+			void stop(void);
+			bool isFinished(void);
+
+			/* Getters & setters */
+			double getDistance(void);
+			double getPosition(void);
+			double getVelocity(void);
+			double getAcceleration(void);
+			double getRemaining(void);
+
+			void setLimits(double maxVelocity, double maxAcceleration, double maxJerk = 0.0);
+			double getMaxVelocity(void);
+			double getMaxAcceleration(void);
+			double getMaxJerk(void);
+
+		private:
+			double getStoppingDistance(void);
+
+			double maxVelocity;
+			double maxAcceleration;
+			double maxJerk;
+
+			// The move is planned along its absolute distance, sign holds the direction
+			double distance;
+			int sign;
+			double position;
+			double velocity;
+			double acceleration;
+			bool finished;
+	};
+}
+
+#endif
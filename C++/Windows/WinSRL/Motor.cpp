@@ -37,6 +37,66 @@ SRL::Motor::Motor(unsigned int forwardPin, unsigned int backwardPin, unsigned in
 	pinMode(this->backwardPin, OUTPUT);
 	pinMode(this->pwmPin, OUTPUT);
 
+#ifdef MOTOR_FAST_IO
+	// Also turns off any PWM on the direction pins, so they can be written directly
+	digitalWrite(this->forwardPin, LOW);
+	digitalWrite(this->backwardPin, LOW);
+
+	forwardRegister = portOutputRegister(digitalPinToPort(forwardPin));
+	forwardMask = digitalPinToBitMask(forwardPin);
+	backwardRegister = portOutputRegister(digitalPinToPort(backwardPin));
+	backwardMask = digitalPinToBitMask(backwardPin);
+
+	pwmRegister8 = NULL;
+	pwmRegister16 = NULL;
+	pwmConnected = false;
+
+	switch (digitalPinToTimer(pwmPin))
+	{
+#if defined(OCR0A)
+		case TIMER0A: pwmRegister8 = &OCR0A; break;
+#endif
+#if defined(OCR0B)
+		case TIMER0B: pwmRegister8 = &OCR0B; break;
+#endif
+#if defined(OCR1A)
+		case TIMER1A: pwmRegister16 = &OCR1A; break;
+#endif
+#if defined(OCR1B)
+		case TIMER1B: pwmRegister16 = &OCR1B; break;
+#endif
+#if defined(OCR1C)
+		case TIMER1C: pwmRegister16 = &OCR1C; break;
+#endif
+#if defined(OCR2)
+		case TIMER2: pwmRegister8 = &OCR2; break;
+#endif
+#if defined(OCR2A)
+		case TIMER2A: pwmRegister8 = &OCR2A; break;
+#endif
+#if defined(OCR2B)
+		case TIMER2B: pwmRegister8 = &OCR2B; break;
+#endif
+#if defined(OCR3A)
+		case TIMER3A: pwmRegister16 = &OCR3A; break;
+		case TIMER3B: pwmRegister16 = &OCR3B; break;
+		case TIMER3C: pwmRegister16 = &OCR3C; break;
+#endif
+#if defined(OCR4A) && defined(OCR4C) && !defined(OCR4D)
+		case TIMER4A: pwmRegister16 = &OCR4A; break;
+		case TIMER4B: pwmRegister16 = &OCR4B; break;
+		case TIMER4C: pwmRegister16 = &OCR4C; break;
+#endif
+#if defined(OCR5A)
+		case TIMER5A: pwmRegister16 = &OCR5A; break;
+		case TIMER5B: pwmRegister16 = &OCR5B; break;
+		case TIMER5C: pwmRegister16 = &OCR5C; break;
+#endif
+		default:
+			break;
+	}
+#endif
+
 	forwards();
 	stop();
 
@@ -53,8 +113,8 @@ SRL::Motor::~Motor(void)
 */
 void SRL::Motor::start(void)
 {
-	analogWrite(pwmPin, (int ((SRL::PWM_MAX_VALUE / 100.0f) * speed)));
 	moving = true;
+	writePwm();
 }
 
 /**
@@ -62,8 +122,55 @@ void SRL::Motor::start(void)
 */
 void SRL::Motor::stop(void)
 {
-	digitalWrite(pwmPin, LOW);
 	moving = false;
+	writeOutput();
+}
+
+/**
+*	Outputs the duty cycle if the motor runs, turns the PWM pin off otherwise.
+*/
+void SRL::Motor::writeOutput(void)
+{
+	if (moving)
+	{
+		writePwm();
+		return;
+	}
+
+	digitalWrite(pwmPin, LOW);
+
+#ifdef MOTOR_FAST_IO
+	pwmConnected = false;
+#endif
+}
+
+/**
+*	Outputs the duty cycle on the PWM pin. Once analogWrite() has connected
+*	the timer to the pin, only the timer's compare register is updated.
+*	0 and PWM_MAX_VALUE are left to analogWrite(), which outputs them as
+*	constant levels.
+*/
+void SRL::Motor::writePwm(void)
+{
+#ifdef MOTOR_FAST_IO
+	if (pwmConnected && duty != SRL::PWM_MIN_VALUE && duty != SRL::PWM_MAX_VALUE)
+	{
+		if (pwmRegister8 != NULL)
+		{
+			*pwmRegister8 = duty;
+			return;
+		}
+		if (pwmRegister16 != NULL)
+		{
+			*pwmRegister16 = duty;
+			return;
+		}
+	}
+
+	pwmConnected = (duty != SRL::PWM_MIN_VALUE && duty != SRL::PWM_MAX_VALUE);
+#endif
+
+	analogWrite(pwmPin, duty);
 }
 
 /**
@@ -73,23 +180,147 @@ void SRL::Motor::stop(void)
 */
 void SRL::Motor::setDirection(unsigned int state)
 {
-	switch (state)
+	if (state != FORWARD && state != BACKWARD)
 	{
-		case FORWARD:
-			digitalWrite(forwardPin, HIGH);
-			digitalWrite(backwardPin, LOW);
-			direction = state;
-			break;
+		return;
+	}
 
-		case BACKWARD:
-			digitalWrite(forwardPin, LOW);
-			digitalWrite(backwardPin, HIGH);
-			direction = state;
-			break;
+	direction = state;
+	writeDirection();
+}
 
-		default:
-			break;
+/**
+*	Outputs the direction on the direction pins.
+*/
+void SRL::Motor::writeDirection(void)
+{
+#ifdef MOTOR_FAST_IO
+	// The ports may be shared with pins written by interrupts
+	uint8_t oldSREG = SREG;
+	cli();
+
+	if (direction == FORWARD)
+	{
+		*backwardRegister &= ~backwardMask;
+		*forwardRegister |= forwardMask;
+	}
+	else
+	{
+		*forwardRegister &= ~forwardMask;
+		*backwardRegister |= backwardMask;
+	}
+
+	SREG = oldSREG;
+#else
+	digitalWrite(forwardPin, (direction == FORWARD) ? HIGH : LOW);
+	digitalWrite(backwardPin, (direction == FORWARD) ? LOW : HIGH);
+#endif
+}
+
+/**
+*	Sets the direction output by the next commit(), without writing the pins.
+*
+*	@param state The direction to set the motor to.
+*/
+void SRL::Motor::stageDirection(unsigned int state)
+{
+	if (state == FORWARD || state == BACKWARD)
+	{
+		direction = state;
+	}
+}
+
+/**
+*	Sets the speed output by the next commit(), without writing the pins.
+*
+*	@param speed Speed of the motor in percent.
+*/
+void SRL::Motor::stageSpeed(float speed)
+{
+	if (speed >= 0 && speed <= 100)
+	{
+		duty = (uint8_t) (SRL::PWM_MAX_VALUE * speed / 100.0f + 0.5f);
+	}
+}
+
+/**
+*	Sets the duty cycle output by the next commit(), without writing the pin.
+*
+*	@param duty The duty cycle, 0 to PWM_MAX_VALUE.
+*/
+void SRL::Motor::stageDuty(uint8_t duty)
+{
+	this->duty = duty;
+}
+
+/**
+*	Sets whether the motor runs after the next commit(), without writing the pins.
+*
+*/
+void SRL::Motor::stageMoving(bool moving)
+{
+	this->moving = moving;
+}
+
+/**
+*	Outputs the staged direction, speed and state of two motors at once, so
+*	no interrupt and no load sees one motor updated and the other not. On
+*	AVR the direction pins of both motors are written with one store per
+*	port, and the PWM outputs right after, all with interrupts disabled.
+*
+*	@param first The first motor.
+*	@param second The second motor.
+*/
+void SRL::Motor::commit(Motor* first, Motor* second)
+{
+#ifdef MOTOR_FAST_IO
+	volatile uint8_t* registers[4];
+	uint8_t clear[4];
+	uint8_t set[4];
+	uint8_t count = 0;
+
+	Motor* motors[2] = { first, second };
+
+	for (uint8_t i = 0; i < 2; i++)
+	{
+		bool forward = motors[i]->direction == FORWARD;
+		addPinWrite(registers, clear, set, &count, motors[i]->forwardRegister, motors[i]->forwardMask, forward);
+		addPinWrite(registers, clear, set, &count, motors[i]->backwardRegister, motors[i]->backwardMask, !forward);
+	}
+
+	uint8_t oldSREG = SREG;
+	cli();
+
+	for (uint8_t i = 0; i < count; i++)
+	{
+		*registers[i] = (*registers[i] & ~clear[i]) | set[i];
 	}
+
+	first->writeOutput();
+	second->writeOutput();
+
+	SREG = oldSREG;
+#else
+	SRL_ATOMIC_BEGIN();
+
+	first->writeDirection();
+	second->writeDirection();
+	first->writeOutput();
+	second->writeOutput();
+
+	SRL_ATOMIC_END();
+#endif
+}
+
+/**
+*	Outputs the staged direction, speed and state of the motor.
+*/
+void SRL::Motor::commit(void)
+{
+	SRL_ATOMIC_BEGIN();
+	writeDirection();
+	writeOutput();
+	SRL_ATOMIC_END();
 }
 
 unsigned int SRL::Motor::getDirection(void)
@@ -130,7 +361,7 @@ unsigned int SRL::Motor::getPwmPin(void)
 
 float SRL::Motor::getSpeed(void)
 {
-	return speed;
+	return duty * 100.0f / SRL::PWM_MAX_VALUE;
 }
 
 /**
@@ -142,11 +373,73 @@ void SRL::Motor::setSpeed(float speed)
 {
 	if (speed >= 0 && speed <= 100)
 	{
-		this->speed = speed;
+		duty = (uint8_t) (SRL::PWM_MAX_VALUE * speed / 100.0f + 0.5f);
 
 		if (moving)
 		{
-			start();
+			writePwm();
 		}
 	}
 }
+
+/**
+*	Sets the motor's speed as a duty cycle, without floating point math.
+*
+*	@param duty The duty cycle, 0 to PWM_MAX_VALUE.
+*/
+void SRL::Motor::setDuty(uint8_t duty)
+{
+	this->duty = duty;
+
+	if (moving)
+	{
+		writePwm();
+	}
+}
+
+uint8_t SRL::Motor::getDuty(void)
+{
+	return duty;
+}
+
+/**
+*	Returns whether the motor is started.
+*/
+bool SRL::Motor::isMoving(void)
+{
+	return moving;
+}
+
+#ifdef MOTOR_FAST_IO
+/**
+*	Adds a pin to the port writes of commit(), merged with the pins of the
+*	same port.
+*/
+void SRL::Motor::addPinWrite(volatile uint8_t** registers, uint8_t* clear, uint8_t* set, uint8_t* count,
+	volatile uint8_t* reg, uint8_t mask, bool high)
+{
+	uint8_t i = 0;
+
+	while (i < *count && registers[i] != reg)
+	{
+		i++;
+	}
+
+	if (i == *count)
+	{
+		registers[i] = reg;
+		clear[i] = 0;
+		set[i] = 0;
+		(*count)++;
+	}
+
+	if (high)
+	{
+		set[i] |= mask;
+	}
+	else
+	{
+		clear[i] |= mask;
+	}
+}
+#endif
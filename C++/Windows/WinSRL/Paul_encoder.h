@@ -33,7 +33,10 @@ class Paul_Encoder
 	public:
 		Paul_Encoder(unsigned int, unsigned int);
 		long read(void);
-		void write(int);
+		virtual void write(int32_t);
+		long peek(void);
+		void poke(int32_t);
+		void readEdges(int32_t*, uint32_t*, uint32_t*, int8_t*);
 };
 
 #endif
\ No newline at end of file
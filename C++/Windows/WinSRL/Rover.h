@@ -38,10 +38,41 @@
 #include "Encoder.h"
 #include "AccelGyro.h"
 
+// Control
+#include "SpeedController.h"
+#include "MotionProfile.h"
+#include "Executive.h"
+
 // Standard Template Library
 #include "Vector.h"
 
 #define PRECISION 0.25 // Precision of movement methods
+#define ROVER_DEFAULT_CRUISE_SPEED 20.0 // cm/s
+#define ROVER_DEFAULT_ACCELERATION 40.0 // cm/s^2
+#define ROVER_DEFAULT_JERK 200.0 // cm/s^3
+#define ROVER_DEFAULT_TRACK_WIDTH TANK_DEFAULT_TRACK_WIDTH // cm
+#define ROVER_SYNC_GAIN 20 // step/s of speed difference per step of progress difference
+#define ROVER_TURN_TOLERANCE 1.0 // deg, a turn ends this close to its goal
+#define ROVER_TURN_RATE_GAIN 0.5 // deg/s of correction per deg/s of turn rate error
+#define ROVER_GYRO_TIMEOUT 50000 // us, older gyroscope samples are not used for the heading
+#define ROVER_GOAL_TOLERANCE 1.0 // cm, goTo() ends this close to its goal
+#define ROVER_PIVOT_ANGLE 60.0 // deg, goTo() turns in place while the goal is further off the heading
+#define ROVER_LOOKAHEAD 10.0 // cm, distance along the path the rover steers towards
+#define ROVER_MAX_WAYPOINTS 8
+#define ROVER_GRAVITY 980.665 // cm/s^2 per g
+#define ROVER_SLIP_ACCELERATION 100.0 // cm/s^2, larger differences of the wheels' and the AccelGyro's acceleration are slip
+#define ROVER_SLIP_YAW_RATE 20.0 // deg/s, larger differences of the wheels' and the gyroscope's turn rate are slip
+#define ROVER_SLIP_YAW_FRACTION 0.5 // of the turn rate, tolerated on top of ROVER_SLIP_YAW_RATE as tracks skid in turns
+#define ROVER_SLIP_VELOCITY 2.0 // cm/s, larger differences of the wheels' and the estimated velocity are slip
+#define ROVER_SLIP_HOLD 100000 // us, slip ends once it was not detected for this long
+#define ROVER_SLIP_GRIP_WEIGHT 0.02 // weight of the encoders in the estimated velocity while gripping
+#define ROVER_SLIP_ENCODER_WEIGHT 0.0 // weight of the encoders in the estimated velocity while slipping, 0 follows the AccelGyro alone
+#define ROVER_SLIP_BIAS_GAIN 0.005 // per update, rate the AccelGyro's bias, e.g. from a slope, is learned at
+#define ROVER_GYRO_BIAS_STILL_TIME 500000 // us the rover stands still before learnGyroBias() learns the gyroscope's bias
+#define ROVER_GYRO_BIAS_INTERVAL 10000000 // us, learnGyroBias() learns the gyroscope's bias at most this often
+#define ROVER_CORRECT_MOTORS_PRIORITY 3
+#define ROVER_CONTROL_HEADING_PRIORITY 2
+#define ROVER_UPDATE_POSITION_PRIORITY 1
 
 namespace SRL
 {
@@ -64,14 +95,25 @@ namespace SRL
 			void turnRight(double amount = 90.0f);
 			void turnLeft(double amount = 90.0f);
 			void goTo(double x, double y);
+			void drive(double velocity, double curvature = 0.0);
+
+			/* Waypoint commands */
+			uint8_t addWaypoint(double x, double y);
+			void clearWaypoints(void);
+			uint8_t getWaypointCount(void);
+			unsigned int getWaypointsReached(void);
+			double getRemainingDistance(void);
+			bool isMoving(void);
 			void turnTo(SRL::Angle dir);
 			void stop(void);
 
 			/* ISRs */
 			void correctMotors(void);
+			void controlHeading(void);
 			void updatePosition(void);
 
 			/* Getters & setters */
+			void getPose(double* x, double* y, float* direction);
 			float getDirection(void);
 			void setDirection(float direction);
 			double getX(void);
@@ -89,10 +131,26 @@ namespace SRL
 			Motor* getRightMotor(void);
 			Motor* getLeftMotor(void);
 
+			void setCruiseSpeed(double cruiseSpeed);
+			double getCruiseSpeed(void);
+			SpeedController* getLeftSpeedController(void);
+			SpeedController* getRightSpeedController(void);
+			MotionProfile* getMotionProfile(void);
+			void setTrackWidth(double trackWidth);
+			double getTrackWidth(void);
+
+			bool isSlipping(void);
+			unsigned int getSlipCount(void);
+			void setTractionControl(bool tractionControl);
+			bool getTractionControl(void);
+
+			uint8_t learnGyroBias(void);
+
 			/* Enums */
 			enum Intervals
 			{
 				UPDATE_POSITION_INTERVAL = 20000,
+				CONTROL_HEADING_INTERVAL = 5000,
 				CORRECT_MOTORS_INTERVAL = 500
 			};
 
@@ -108,14 +166,67 @@ namespace SRL
 
 			/* Movement related fields */
 			bool turning = false;
-			SRL::Angle turnGoal;
+			float turnRemaining;
 
 			bool movingStraight = false;
 			double xGoal, yGoal;
 
+			bool driving = false;
+			bool seeking = false;
+
+			/* Speed control related fields */
+			SRL::SpeedController leftSpeed;
+			SRL::SpeedController rightSpeed;
+			SRL::MotionProfile profile;
+			long leftStart, rightStart;
+
+			/* Heading control related fields */
+			float turnRate;
+			double turnSpeed;
+			long leftHeading, rightHeading;
+
+			/* Arc drive related fields */
+			double driveVelocity;
+			double driveCurvature;
+			float driveRate;
+			double driveSpeed;
+
+			/* Waypoint related fields */
+			double waypointX[ROVER_MAX_WAYPOINTS];
+			double waypointY[ROVER_MAX_WAYPOINTS];
+			uint8_t waypointHead, waypointCount;
+			unsigned int waypointsReached;
+			double pathX, pathY;
+			double pathLength;
+
+			/* Slip detection related fields */
+			bool slipping = false;
+			bool tractionControl = false;
+			unsigned int slipCount;
+			unsigned long slipTime;
+			double slipVelocity;
+			double encoderVelocity;
+			double accelBias;
+
+			/* Gyroscope bias related fields */
+			bool standing = false;
+			unsigned long standingSince;
+			unsigned long gyroBiasTime;
+
 	 private:
 			/* Movement related methods */
-			float getCorrectionSpeed(float x);
+			void startMotion(double distance);
+			void startTurn(double amount);
+			void driveMotors(void);
+			void seekGoal(float rate);
+			void nextWaypoint(void);
+			void setTargets(long left, long right);
+			double detectSlip(double left, double right);
+
+			/* Executive tasks */
+			static void correctMotorsTask(void* rover);
+			static void controlHeadingTask(void* rover);
+			static void updatePositionTask(void* rover);
 	};
 }
 #endif
@@ -30,28 +30,21 @@
 */
 void SRL::sendInt16(int16_t num)
 {
-	byte* o = new byte[2];
-	o[0] = num >> 8;
-	o[1] = num;
+	byte o[2] = { (byte) (num >> 8), (byte) (num & 0xFF) };
 	Serial.write(o, 2);
-	Serial.flush();
-	delete[] o;
 }
 
 /**
-*	Reads an int16_t from the serial buffer.
-*
+*	Reads an int16_t from the serial buffer. At least 2 bytes must be
+*	available.
 *
 */
 int16_t SRL::readInt16(void)
 {
-	int len = Serial.available();
-	byte* k = new byte[len];
-    Serial.readBytes(k, len);
-    int16_t out = k[len-2] << 8 | k[len-1];
-    delete[] k;
-    
-    return out;
+	int16_t out = Serial.read() << 8;
+	out |= Serial.read();
+	
+	return out;
 }
 
 /**
@@ -61,17 +54,23 @@ int16_t SRL::readInt16(void)
 */
 int16_t SRL::calculateSum(String str)
 {
-	char* c = new char[str.length()+1];
-    str.toCharArray(c, str.length()+1);
-
-    int16_t sum = 0;
-    for (int i = 0; i < str.length()+1; i++)
-    {
-      sum += (int) c[i];
-    }
-    delete[] c;
-  
-    return sum;
+	return calculateSum(str.c_str());
+}
+
+/**
+*	Returns the ASCII sum of a string.
+*
+*	@param str
+*/
+int16_t SRL::calculateSum(const char* str)
+{
+	int16_t sum = 0;
+	while (*str != '\0')
+	{
+		sum += (int) *str++;
+	}
+	
+	return sum;
 }
 
 /**
@@ -81,5 +80,123 @@ int16_t SRL::calculateSum(String str)
 */
 int16_t SRL::calculateSum(int16_t signal)
 {
-	return calculateSum(String(signal));
+	// Sums the decimal digits without printing them to a String
+	long value = signal;
+	int16_t sum = 0;
+	
+	if (value < 0)
+	{
+		sum += '-';
+		value = -value;
+	}
+	
+	do
+	{
+		sum += '0' + value % 10;
+		value /= 10;
+	}
+	while (value > 0);
+	
+	return sum;
+}
+
+/**
+*	COBS encodes bytes, so they contain no 0 bytes. The 0 byte ending the
+*	frame is not added.
+*
+*	@param data The bytes to encode.
+*	@param len The number of bytes, at most 253.
+*	@param out The buffer of at least len + 1 bytes.
+*	@return Returns the number of encoded bytes.
+*/
+uint8_t SRL::cobsEncode(const byte* data, uint8_t len, byte* out)
+{
+	uint8_t codeIndex = 0;
+	uint8_t code = 1;
+	uint8_t o = 1;
+
+	for (uint8_t i = 0; i < len; i++)
+	{
+		if (data[i] == 0)
+		{
+			out[codeIndex] = code;
+			codeIndex = o++;
+			code = 1;
+		}
+		else
+		{
+			out[o++] = data[i];
+			code++;
+		}
+	}
+
+	out[codeIndex] = code;
+	return o;
+}
+
+/**
+*	Decodes COBS encoded bytes in place. The decoded bytes are never longer
+*	than the encoded ones.
+*
+*	@param data The encoded bytes without the ending 0 byte.
+*	@param len The number of encoded bytes.
+*	@return Returns the number of decoded bytes, 0 if the bytes are not valid COBS.
+*/
+uint8_t SRL::cobsDecode(byte* data, uint8_t len)
+{
+	uint8_t in = 0;
+	uint8_t out = 0;
+
+	while (in < len)
+	{
+		uint8_t code = data[in++];
+
+		if (code == 0 || in + code - 1 > len)
+		{
+			return 0;
+		}
+
+		for (uint8_t i = 1; i < code; i++)
+		{
+			data[out++] = data[in++];
+		}
+
+		if (code < 0xFF && in < len)
+		{
+			data[out++] = 0;
+		}
+	}
+
+	return out;
+}
+
+/**
+*	Encodes a SCOM2000 frame, including the 0 byte ending it.
+*
+*	@param type The frame's type.
+*	@param sequence The frame's sequence number.
+*	@param payload The frame's payload.
+*	@param len The payload's length, at most SCOM_MAX_PAYLOAD bytes.
+*	@param out The buffer of at least len + SCOM_FRAME_OVERHEAD + 2 bytes.
+*	@return Returns the number of encoded bytes.
+*/
+uint8_t SRL::encodeFrame(uint8_t type, uint8_t sequence, const byte* payload, uint8_t len, byte* out)
+{
+	byte frame[SCOM_MAX_FRAME];
+
+	frame[0] = type;
+	frame[1] = sequence;
+	if (len > 0)
+	{
+		memcpy(frame + 2, payload, len);
+	}
+
+	uint16_t crc = crc16(frame, len + 2);
+	frame[len + 2] = highByte(crc);
+	frame[len + 3] = lowByte(crc);
+
+	uint8_t n = cobsEncode(frame, len + SCOM_FRAME_OVERHEAD, out);
+	out[n++] = SCOM_FRAME_DELIMITER;
+
+	return n;
 }
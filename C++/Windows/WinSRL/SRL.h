@@ -27,6 +27,10 @@
 
 #include <VirtualArduino.h>
 
+// Critical section that keeps the caller's interrupt flag, so it can be used in ISRs too
+#define SRL_ATOMIC_BEGIN() noInterrupts()
+#define SRL_ATOMIC_END() interrupts()
+
 namespace SRL
 {
 	const unsigned int PWM_MAX_VALUE = 255;
@@ -0,0 +1,206 @@
+/*
+* MIT License
+*
+* Copyright (c) 2021 Robert Hutter
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+#include "SensorHub.h"
+
+/**
+* Class SensorHub's constructor.
+*
+* @param budget The longest time a call to run() may spend sampling, in micro seconds.
+*/
+SRL::SensorHub::SensorHub(unsigned long budget)
+{
+  this->budget = budget;
+  this->count = 0;
+  this->overruns = 0;
+}
+
+/**
+* Registers a component.
+*
+* @param component The component to sample.
+* @param rate The target sample rate in Hz.
+* @param cost The estimated time a sample takes, in micro seconds. The
+* estimate is refined with the measured time of every sample.
+* @return
+* Returns the component's index, -1 if the hub is full, the rate is 0 or
+* the cost exceeds the budget.
+*/
+int8_t SRL::SensorHub::add(SRL::Component* component, unsigned int rate, unsigned long cost)
+{
+  if (count >= SENSOR_HUB_MAX_SENSORS || rate == 0 || cost > budget)
+  {
+    return -1;
+  }
+
+  Task* task = &tasks[count];
+  task->component = component;
+  task->period = 1000000UL / rate;
+  task->cost = cost;
+  task->due = micros();
+  task->misses = 0;
+
+  return count++;
+}
+
+/**
+* Takes the samples that are due, earliest deadline first, as long as their
+* estimated cost fits into the remaining budget. A sample that does not fit
+* waits for a later call, so a slow sensor never stalls loop(). Due times
+* advance by whole periods, so rates do not drift with loop jitter.
+*
+* @return
+* Returns the number of samples taken.
+*/
+uint8_t SRL::SensorHub::run(void)
+{
+  unsigned long start = micros();
+  unsigned long spent = 0;
+  uint8_t taken = 0;
+  int8_t i;
+
+  // An estimate raised above the budget by a one-off slow sample would never
+  // fit again, let it decay so the component is retried
+  for (uint8_t j = 0; j < count; j++)
+  {
+    Task* task = &tasks[j];
+
+    if (task->cost > budget && (long) (start - task->due) >= 0)
+    {
+      task->cost -= task->cost / 8;
+      task->misses++;
+      task->due = start + task->period;
+    }
+  }
+
+  while ((i = next(start + spent, budget > spent ? budget - spent : 0)) >= 0)
+  {
+    Task* task = &tasks[i];
+    unsigned long t = micros();
+
+    task->component->sample();
+
+    unsigned long cost = micros() - t;
+    task->cost += ((long) cost - (long) task->cost) / 4;
+
+    task->due += task->period;
+
+    // Skip the periods that were missed instead of sampling in a burst
+    if ((long) (t - task->due) >= 0)
+    {
+      task->misses += (t - task->due) / task->period + 1;
+      task->due = t + task->period;
+    }
+
+    spent = micros() - start;
+    taken++;
+  }
+
+  if (spent > budget)
+  {
+    overruns++;
+  }
+
+  return taken;
+}
+
+/**
+* Returns the index of the due task with the earliest deadline that fits
+* into the remaining budget, -1 if there is none.
+*/
+int8_t SRL::SensorHub::next(unsigned long now, unsigned long remaining)
+{
+  int8_t best = -1;
+
+  for (uint8_t i = 0; i < count; i++)
+  {
+    if ((long) (now - tasks[i].due) < 0 || tasks[i].cost > remaining)
+    {
+      continue;
+    }
+
+    if (best < 0 || (long) (tasks[i].due - tasks[best].due) < 0)
+    {
+      best = i;
+    }
+  }
+
+  return best;
+}
+
+/**
+* Resets the overrun and miss counters.
+*/
+void SRL::SensorHub::resetCounters(void)
+{
+  overruns = 0;
+
+  for (uint8_t i = 0; i < count; i++)
+  {
+    tasks[i].misses = 0;
+  }
+}
+
+unsigned long SRL::SensorHub::getBudget(void)
+{
+  return budget;
+}
+
+void SRL::SensorHub::setBudget(unsigned long budget)
+{
+  this->budget = budget;
+}
+
+uint8_t SRL::SensorHub::getCount(void)
+{
+  return count;
+}
+
+/**
+* Returns the number of run() calls that took longer than the budget.
+*/
+unsigned int SRL::SensorHub::getOverruns(void)
+{
+  return overruns;
+}
+
+SRL::Component* SRL::SensorHub::getComponent(uint8_t index)
+{
+  return index < count ? tasks[index].component : NULL;
+}
+
+/**
+* Returns the current estimate of a component's sample time in micro seconds.
+*/
+unsigned long SRL::SensorHub::getCost(uint8_t index)
+{
+  return index < count ? tasks[index].cost : 0;
+}
+
+/**
+* Returns the number of periods a component was not sampled in.
+*/
+unsigned int SRL::SensorHub::getMisses(uint8_t index)
+{
+  return index < count ? tasks[index].misses : 0;
+}
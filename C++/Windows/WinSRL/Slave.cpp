@@ -29,7 +29,9 @@
 */
 SRL::Slave::Slave()
 {
-
+	linkState = LINK_CLOSED;
+	commands = NULL;
+	reset();
 }
 
 /**
@@ -42,85 +44,259 @@ SRL::Slave::~Slave()
 }
 
 /**
-*	Open the SCOM communication. Waits for the master.
+*	Open the SCOM communication. Does not wait for the master, updateSCOM()
+*	negotiates the link with it. SCOM2000 masters are answered with frames,
+*	SCOM1204 masters with the int16 handshake.
 *
 *	@param baudRate The serial connection's baud rate.
 */
-uint8_t SRL::Slave::openSCOM(unsigned int baudRate)
+void SRL::Slave::openSCOM(unsigned int baudRate)
 {
 	Serial.begin(baudRate);
-	Serial.setTimeout(2000);
-	mode = SIGNAL_MODE;
-	status = WAITING_FOR_MASTER_SIGNAL;
-	
-	// Wait for SOH signal
-	waitForUpdate();
-	
-	// Get version number
-	status = WAITING_FOR_MASTER_SIGNAL;
-	waitForUpdate();
+	linkState = LINK_CLOSED;
+	reset();
+}
+
+/**
+*	Returns true if a command from the master is waiting to be read.
+*
+*/
+bool SRL::Slave::available(void)
+{
+	return commandReady;
+}
+
+/**
+*	Returns the last command received from the master, NULL if there is no
+*	new one. The command is valid until the next call of updateSCOM().
+*
+*/
+const char* SRL::Slave::readCommand(void)
+{
+	return (const char*) readPayload().data;
+}
+
+/**
+*	Returns a view of the last command received from the master, without
+*	copying it out of the receive buffer. The view is valid until the next
+*	call of updateSCOM(), its data is NULL if there is no new command. No
+*	more bytes are received while a command waits to be read.
+*
+*/
+SRL::Payload SRL::Slave::readPayload(void)
+{
+	if (!commandReady)
+	{
+		Payload none = { NULL, 0 };
+		return none;
+	}
 	
-	// Send version number
-	sendInt16(VERSION);
-	awaitedSum = calculateSum(VERSION);
+	commandReady = false;
+	return command;
+}
+
+/**
+*	Sets the table received commands are dispatched to by updateSCOM().
+*	Without one, commands have to be read with readCommand().
+*
+*	@param commands The command table, NULL to read commands by hand.
+*/
+void SRL::Slave::setCommandTable(SRL::CommandTable* commands)
+{
+	this->commands = commands;
+}
+
+SRL::CommandTable* SRL::Slave::getCommandTable(void)
+{
+	return commands;
+}
+
+/**
+*	Returns the protocol version agreed with the master, 0 if there is none.
+*
+*/
+uint16_t SRL::Slave::getVersion(void)
+{
+	return version;
+}
+
+/**
+*	Returns the number of SCOM2000 commands the master may send ahead of
+*	the ACKs, 1 for stop and wait.
+*
+*/
+uint8_t SRL::Slave::getWindow(void)
+{
+	return window;
+}
+
+/**
+*	Returns the link's state, one of the LinkState values.
+*
+*/
+uint8_t SRL::Slave::getLinkState(void)
+{
+	return linkState;
+}
+
+/**
+*	Returns true if the link with the master is open.
+*
+*/
+bool SRL::Slave::isOpen(void)
+{
+	return linkState == LINK_OPEN;
+}
+
+/**
+*	Updates the SCOM communication from the bytes already received. Never
+*	waits, so call it from the control loop.
+*
+*/
+void SRL::Slave::updateSCOM(void)
+{
+	deliverCommand();
 	
-	// Wait for responce
-	status = WAITING_FOR_MASTER_RESPONCE;
-	waitForUpdate();
+	if (protocol == PROTOCOL_NONE)
+	{
+		if (Serial.available() == 0)
+		{
+			return;
+		}
+		
+		// SCOM1204 starts with SOH's high byte, 0, which never starts a frame
+		protocol = Serial.peek() == SCOM_FRAME_DELIMITER ? PROTOCOL_SCOM1204 : PROTOCOL_SCOM2000;
+		linkState = LINK_CONNECTING;
+		lastActivity = millis();
+		lastFrame = lastActivity;
+	}
 	
-	// Get version compatibility information
-	status = WAITING_FOR_MASTER_SIGNAL;
-	waitForUpdate();
+	if (protocol == PROTOCOL_SCOM2000)
+	{
+		updateFrames();
+	}
+	else
+	{
+		updateSignals();
+	}
 	
-	status = WAITING_FOR_MASTER_SIGNAL;
+	watchTimeout();
+	deliverCommand();
 	
-	return lastMasterSignal == ETB;
+	while (commands != NULL && commandReady)
+	{
+		commands->dispatch(readPayload());
+		deliverCommand();
+	}
 }
 
 /**
-*	Waits for an update from the master.
+*	Frees the slot of the command handed out before once it was read, and
+*	hands out the next command received in order.
 *
 */
-void SRL::Slave::waitForUpdate(void)
+void SRL::Slave::deliverCommand(void)
 {
-	while(status != IN_TIMEOUT_BUFFER)
+	if (commandHeld && !commandReady)
 	{
-		updateSCOM();
-		
-		if (status == OK_CONTINUE)
-			return;
+		received &= ~(1 << (base & (SCOM_WINDOW - 1)));
+		base++;
+		commandHeld = false;
 	}
 	
-	for (int i = 0; i<10; i++)
+	if (!commandReady && base != expected)
 	{
-		delay(200);
-		updateSCOM();
-		
-		if (status == OK_CONTINUE)
-			return;
+		uint8_t slot = base & (SCOM_WINDOW - 1);
+		command.data = slots[slot];
+		command.length = slotLength[slot];
+		commandReady = true;
+		commandHeld = true;
 	}
+}
 
-	// Timeout error!
-	exit(1);
+/**
+*	Forgets the state of the link, so the next master can open it again.
+*
+*/
+void SRL::Slave::reset(void)
+{
+	protocol = PROTOCOL_NONE;
+	mode = SIGNAL_MODE;
+	status = WAITING_FOR_MASTER_SIGNAL;
+	handshake = 0;
+	version = 0;
+	rxLength = 0;
+	rxOverflow = false;
+	cobsCode = 0;
+	cobsLeft = 0;
+	window = 1;
+	expected = 0;
+	base = 0;
+	received = 0;
+	commandReady = false;
+	commandHeld = false;
+	corrupted = false;
 }
 
 /**
-*	Updates the SCOM communication by reading serial input.
+*	Watches communication timeouts. A handshake or exchange the master does
+*	not continue within SCOM_TIMEOUT is abandoned and the link is lost.
+*	So is a SCOM2000 link that only received corrupted frames for
+*	SCOM_TIMEOUT, e.g. when the master answered a late HELLO with SCOM1204
+*	signals, so the protocol is detected again.
 *
+*/
+void SRL::Slave::watchTimeout(void)
+{
+	bool waiting = linkState == LINK_CONNECTING
+		|| (protocol == PROTOCOL_SCOM2000 ? rxLength > 0 : status != WAITING_FOR_MASTER_SIGNAL);
+	bool stale = protocol == PROTOCOL_SCOM2000 && corrupted && millis() - lastFrame >= SCOM_TIMEOUT;
+	
+	if (!stale && (!waiting || millis() - lastActivity < SCOM_TIMEOUT))
+	{
+		return;
+	}
+	
+	linkState = LINK_LOST;
+	reset();
+	
+	// Drop the rest of the abandoned exchange
+	while (Serial.available() > 0)
+	{
+		Serial.read();
+	}
+}
+
+/**
+*	Updates the SCOM1204 communication by reading serial input.
 *
 */
-void SRL::Slave::updateSCOM(void)
+void SRL::Slave::updateSignals(void)
 {
-	//watchTimeout();	
+	if (status == WAITING_FOR_MASTER_COMMAND)
+	{
+		receiveCommand();
+		return;
+	}
 	
 	// Wait for a complete message to arrive
-	if (Serial.available() > 1 || (status == WAITING_FOR_MASTER_COMMAND && Serial.available() > 0))
+	if (Serial.available() > 1)
 	{
+		lastActivity = millis();
+		
 		if (status == WAITING_FOR_MASTER_SIGNAL)
 		{
 			// Read an int16_t
 			lastMasterSignal = readInt16();
 			
+			// The master closes without waiting for an answer
+			if (linkState == LINK_OPEN && lastMasterSignal == EOT)
+			{
+				linkState = LINK_CLOSED;
+				reset();
+				return;
+			}
+			
 			status = WAITING_FOR_MASTER_RESPONCE;
 			
 			sendInt16(calculateSum(lastMasterSignal));
@@ -136,7 +312,8 @@ void SRL::Slave::updateSCOM(void)
 				// Prepair for infomessage
 				if (lastMasterSignal == STX)
 				{
-					status = WAITING_FOR_MASTER_COMMAND;					
+					status = WAITING_FOR_MASTER_COMMAND;
+					rxLength = 0;
 				}
 				
 				if (mode == COMMAND_MODE)
@@ -144,15 +321,11 @@ void SRL::Slave::updateSCOM(void)
 					status = WAITING_FOR_MASTER_SIGNAL;
 					mode = SIGNAL_MODE;
 				}
-
-				return;
 			}
-			
-			if (masterResponce == awaitedSum)
+			else if (masterResponce == awaitedSum)
 			{
 				sendInt16(ACK);
 				status = IN_TIMEOUT_BUFFER;
-				return;
 			}
 			else
 			{
@@ -160,15 +333,6 @@ void SRL::Slave::updateSCOM(void)
 				sendInt16(VERSION);
 			}
 		}
-		else if (status == WAITING_FOR_MASTER_COMMAND)
-		{
-			String command = Serial.readString();
-			
-			status = WAITING_FOR_MASTER_RESPONCE;
-			mode = COMMAND_MODE;
-			
-			sendInt16(calculateSum(command));
-		}
 		else if (status == IN_TIMEOUT_BUFFER)
 		{
 			int16_t masterResponce = readInt16();
@@ -177,7 +341,6 @@ void SRL::Slave::updateSCOM(void)
 			{
 				sendInt16(ACK);
 				status = IN_TIMEOUT_BUFFER;
-				return;
 			}
 		}
 	}
@@ -186,14 +349,285 @@ void SRL::Slave::updateSCOM(void)
 		status = OK_CONTINUE;
 	}
 	
+	if (status == OK_CONTINUE)
+	{
+		advanceHandshake();
+	}
+}
+
+/**
+*	Collects the bytes of a SCOM1204 command in the receive buffer. The
+*	command ends with ';', or when SCOM_MAX_COMMAND bytes were received.
+*
+*/
+void SRL::Slave::receiveCommand(void)
+{
+	// The previous command still lives in the receive buffer
+	if (commandReady)
+	{
+		return;
+	}
+	
+	bool ended = false;
+	
+	while (!ended && Serial.available() > 0 && rxLength < SCOM_MAX_COMMAND)
+	{
+		rxFrame[rxLength] = Serial.read();
+		ended = rxFrame[rxLength++] == ';';
+		lastActivity = millis();
+	}
+	
+	if (!ended && rxLength < SCOM_MAX_COMMAND)
+	{
+		return;
+	}
+	
+	rxFrame[rxLength] = '\0';
+	command.data = rxFrame;
+	command.length = rxLength;
+	commandReady = true;
+	rxLength = 0;
+	
+	status = WAITING_FOR_MASTER_RESPONCE;
+	mode = COMMAND_MODE;
+	
+	sendInt16(calculateSum((const char*) rxFrame));
 }
 
 /**
-*	Watches communication timeouts.
+*	Continues the SCOM1204 handshake once the master confirmed a signal.
 *
+*/
+void SRL::Slave::advanceHandshake(void)
+{
+	status = WAITING_FOR_MASTER_SIGNAL;
+	
+	if (linkState != LINK_CONNECTING)
+	{
+		return;
+	}
+	
+	handshake++;
+	
+	if (handshake == 2)
+	{
+		// Master's version received, send ours
+		sendInt16(VERSION);
+		awaitedSum = calculateSum(VERSION);
+		status = WAITING_FOR_MASTER_RESPONCE;
+		lastActivity = millis();
+	}
+	else if (handshake == 4)
+	{
+		// Version compatibility received
+		if (lastMasterSignal == ETB)
+		{
+			version = VERSION;
+			linkState = LINK_OPEN;
+		}
+		else
+		{
+			linkState = LINK_CLOSED;
+			reset();
+		}
+	}
+}
+
+/**
+*	Decodes the received bytes straight out of the serial ring buffer. Stops
+*	while the window is full of commands waiting to be read, so further
+*	frames wait in the serial buffer.
 *
+*/
+void SRL::Slave::updateFrames(void)
+{
+	while ((uint8_t)(expected - base) < window && Serial.available() > 0)
+	{
+		receiveByte(Serial.read());
+		lastActivity = millis();
+	}
+}
+
+/**
+*	Decodes one COBS encoded byte into the frame buffer. The 0 byte ends
+*	the frame, so no timeout is needed to find frame boundaries.
 *
-void SRL::Slave::watchTimeout(void)
+*	@param data The received byte.
+*/
+void SRL::Slave::receiveByte(byte data)
 {
+	if (data == SCOM_FRAME_DELIMITER)
+	{
+		if (cobsCode != 0)
+		{
+			receiveFrame();
+		}
+		
+		rxLength = 0;
+		rxOverflow = false;
+		cobsCode = 0;
+		cobsLeft = 0;
+		return;
+	}
+	
+	if (cobsLeft == 0)
+	{
+		// A block shorter than 254 bytes was followed by a 0 byte, unless the frame ended
+		bool zero = cobsCode != 0 && cobsCode < 0xFF;
+		
+		cobsCode = data;
+		cobsLeft = data - 1;
+		
+		if (!zero)
+		{
+			return;
+		}
+		
+		data = 0;
+	}
+	else
+	{
+		cobsLeft--;
+	}
+	
+	if (rxLength < SCOM_MAX_FRAME)
+	{
+		rxFrame[rxLength++] = data;
+	}
+	else
+	{
+		rxOverflow = true;
+	}
+}
+
+/**
+*	Handles a complete frame in the receive buffer. Corrupted frames are
+*	NAKed, every command is answered by an ACK of the window's state.
+*
+*/
+void SRL::Slave::receiveFrame(void)
+{
+	uint8_t len = rxLength;
+	
+	// A frame ending inside a block was cut short
+	if (rxOverflow || cobsLeft != 0 || len < SCOM_FRAME_OVERHEAD
+		|| crc16(rxFrame, len - 2) != (uint16_t)((rxFrame[len - 2] << 8) | rxFrame[len - 1]))
+	{
+		sendFrame(SCOM_FRAME_NAK, 0);
+		corrupted = true;
+		return;
+	}
+	
+	lastFrame = millis();
+	corrupted = false;
+	
+	uint8_t type = rxFrame[0];
+	uint8_t sequence = rxFrame[1];
+	byte* payload = rxFrame + 2;
+	len -= SCOM_FRAME_OVERHEAD;
+	
+	if (type == SCOM_FRAME_HELLO && len >= 2)
+	{
+		uint16_t masterVersion = (payload[0] << 8) | payload[1];
+		version = masterVersion < SCOM_VERSION_2 ? masterVersion : SCOM_VERSION_2;
+		linkState = LINK_OPEN;
+		
+		// Masters not asking for a window stop and wait
+		window = len >= 3 && payload[2] > 1 ? payload[2] : 1;
+		window = window < SCOM_WINDOW ? window : SCOM_WINDOW;
+		expected = 0;
+		base = 0;
+		received = 0;
+		commandReady = false;
+		commandHeld = false;
+		
+		byte reply[3] = { highByte(version), lowByte(version), window };
+		sendFrame(SCOM_FRAME_HELLO, sequence, reply, 3);
+	}
+	else if (linkState != LINK_OPEN)
+	{
+		// The master must say HELLO first, e.g. after the slave was reset
+		sendFrame(SCOM_FRAME_NAK, sequence);
+	}
+	else if (type == SCOM_FRAME_COMMAND)
+	{
+		storeCommand(sequence, payload, len);
+		sendAck();
+	}
+	else if (type == SCOM_FRAME_CLOSE)
+	{
+		sendFrame(SCOM_FRAME_ACK, sequence);
+		linkState = LINK_CLOSED;
+		reset();
+	}
+}
+
+/**
+*	Stores a command in its window slot. Commands already stored or read,
+*	i.e. repeated because their ACK was lost, are not stored again. Nor are
+*	commands beyond the window, the master sends them again later.
+*
+*	@param sequence The command's sequence number.
+*	@param payload The command.
+*	@param len The command's length.
+*/
+void SRL::Slave::storeCommand(uint8_t sequence, const byte* payload, uint8_t len)
+{
+	uint8_t slot = sequence & (SCOM_WINDOW - 1);
+	
+	if ((uint8_t)(sequence - base) >= window || (received & (1 << slot)))
+	{
+		return;
+	}
+	
+	memcpy(slots[slot], payload, len);
+	slots[slot][len] = '\0';
+	slotLength[slot] = len;
+	received |= 1 << slot;
+	
+	// Commands received out of order complete once the missing ones arrive
+	while ((uint8_t)(expected - base) < window && (received & (1 << (expected & (SCOM_WINDOW - 1)))))
+	{
+		expected++;
+	}
+}
+
+/**
+*	Sends an ACK of every command before the next expected one, plus a
+*	bitmap of the commands received after it. Bit i stands for the command
+*	i + 1 after the expected one, so the master sends only the missing
+*	ones again.
+*
+*/
+void SRL::Slave::sendAck(void)
+{
+	byte bitmap = 0;
+	
+	for (uint8_t i = 0; i < 7; i++)
+	{
+		uint8_t sequence = expected + 1 + i;
+		
+		if ((uint8_t)(sequence - base) < window && (received & (1 << (sequence & (SCOM_WINDOW - 1)))))
+		{
+			bitmap |= 1 << i;
+		}
+	}
+	
+	sendFrame(SCOM_FRAME_ACK, expected - 1, &bitmap, 1);
+}
+
+/**
+*	Sends a frame to the master.
+*
+*	@param type The frame's type.
+*	@param sequence The frame's sequence number.
+*	@param payload The frame's payload.
+*	@param len The payload's length, at most SCOM_MAX_PAYLOAD bytes.
+*/
+void SRL::Slave::sendFrame(uint8_t type, uint8_t sequence, const byte* payload, uint8_t len)
+{
+	byte encoded[SCOM_MAX_ENCODED + 1];
+	
+	Serial.write(encoded, encodeFrame(type, sequence, payload, len, encoded));
+}
 
-}*/
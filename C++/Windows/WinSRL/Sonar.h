@@ -26,6 +26,7 @@
 
 #include "SRL.h"
 #include "Component.h"
+#include "Sample.h"
 
 #define NO_ECHO 0
 #define PING_MEDIAN_DELAY 29000
@@ -45,6 +46,10 @@ namespace SRL
       double pingMedianCm(unsigned int interations = 5);
       double pingMedianMm(unsigned int interations = 5);
 
+      Sample<unsigned long> samplePing(void);
+      Sample<unsigned long> getPingSample(void);
+      void sample(void);
+
       virtual double convertCm(unsigned long us) = 0;
       double convertMm(unsigned long us);
       virtual unsigned long convertUs(double cm) = 0;
@@ -65,6 +70,8 @@ namespace SRL
       uint8_t echoPin;
 
       unsigned long maxDistance;
+
+      Sample<unsigned long> pingSample;
   };
 }
 
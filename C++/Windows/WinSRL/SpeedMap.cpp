@@ -0,0 +1,278 @@
+/*
+* MIT License
+*
+* Copyright (c) 2018 Robert Hutter
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+#include "SpeedMap.h"
+
+/**
+*	Constructor of class SpeedMap.
+*
+*	@param maxSpeed The speed at full duty cycle the linear map starts out with.
+*/
+SRL::SpeedMap::SpeedMap(long maxSpeed)
+{
+	reset(maxSpeed);
+}
+
+/**
+*	Forgets the learned curve and makes the map linear.
+*
+*	@param maxSpeed The speed at full duty cycle in steps/s.
+*/
+void SRL::SpeedMap::reset(long maxSpeed)
+{
+	SRL_ATOMIC_BEGIN();
+
+	for (uint8_t i = 0; i < SPEED_MAP_POINTS; i++)
+	{
+		speeds[i] = maxSpeed * i / (SPEED_MAP_POINTS - 1);
+	}
+
+	SRL_ATOMIC_END();
+
+	restart();
+}
+
+/**
+*	Adds a measurement to the map. Call it at every control update while the
+*	motor runs. The measurements are averaged over windows of SPEED_MAP_WINDOW
+*	us, and a window is only learned from if its duty cycle and speed match the
+*	previous window's, so the motor had settled at that duty cycle.
+*
+*	@param duty The duty cycle the motor ran at.
+*	@param speed The speed measured in steps/s, not negative.
+*/
+void SRL::SpeedMap::learn(uint8_t duty, long speed)
+{
+	unsigned long now = micros();
+
+	if (samples == 0)
+	{
+		windowStart = now;
+	}
+
+	dutySum += duty;
+	speedSum += speed;
+	samples++;
+
+	if (now - windowStart < SPEED_MAP_WINDOW)
+	{
+		return;
+	}
+
+	int average = (int) ((dutySum << SPEED_MAP_DUTY_SHIFT) / samples);
+	long speedAverage = speedSum / samples;
+
+	if (lastDuty >= 0 && abs(average - lastDuty) <= SPEED_MAP_STEADY_DUTY
+		&& labs(speedAverage - lastSpeed) <= (speedAverage >> SPEED_MAP_STEADY_SHIFT))
+	{
+		update(average, speedAverage);
+	}
+
+	lastDuty = average;
+	lastSpeed = speedAverage;
+	dutySum = 0;
+	speedSum = 0;
+	samples = 0;
+}
+
+/**
+*	Discards the measurements since the last learned window. Call it while the
+*	motor stops or reverses, so those are not learned from.
+*/
+void SRL::SpeedMap::restart(void)
+{
+	dutySum = 0;
+	speedSum = 0;
+	samples = 0;
+	lastDuty = -1;
+	lastSpeed = 0;
+}
+
+/**
+*	Returns the speed the motor turns at with a duty cycle, in steps/s.
+*
+*	@param duty The duty cycle.
+*/
+long SRL::SpeedMap::getSpeed(uint8_t duty)
+{
+	return interpolate((unsigned int) duty << SPEED_MAP_DUTY_SHIFT);
+}
+
+/**
+*	Returns the duty cycle the motor needs to turn at a speed. The point pair
+*	around the speed is found by binary search and interpolated between.
+*
+*	@param speed The speed in steps/s.
+*	@return Returns the duty cycle, 0 for speeds not above 0 and
+*	SRL::PWM_MAX_VALUE for speeds the motor does not reach.
+*/
+uint8_t SRL::SpeedMap::getDuty(long speed)
+{
+	if (speed <= 0)
+	{
+		return 0;
+	}
+
+	if (speed >= speeds[SPEED_MAP_POINTS - 1])
+	{
+		return SRL::PWM_MAX_VALUE;
+	}
+
+	// speeds[low] < speed <= speeds[high]
+	uint8_t low = 0;
+	uint8_t high = SPEED_MAP_POINTS - 1;
+
+	while (high - low > 1)
+	{
+		uint8_t middle = (low + high) / 2;
+
+		if (speeds[middle] < speed)
+		{
+			low = middle;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+
+	long range = speeds[high] - speeds[low];
+
+	return low * SPEED_MAP_POINT_DUTY + ((speed - speeds[low]) * SPEED_MAP_POINT_DUTY + range / 2) / range;
+}
+
+/**
+*	Returns the speed at a point of the map.
+*
+*	@param index The point, at duty cycle index * SPEED_MAP_POINT_DUTY.
+*/
+long SRL::SpeedMap::getPoint(uint8_t index)
+{
+	return (index < SPEED_MAP_POINTS) ? speeds[index] : 0;
+}
+
+uint8_t SRL::SpeedMap::getCalibrationSize(void)
+{
+	return sizeof(speeds);
+}
+
+/**
+*	Writes the map's points to a buffer.
+*
+*	@param data The buffer of getCalibrationSize() bytes.
+*/
+void SRL::SpeedMap::saveCalibration(byte* data)
+{
+	SRL_ATOMIC_BEGIN();
+	memcpy(data, speeds, sizeof(speeds));
+	SRL_ATOMIC_END();
+}
+
+/**
+*	Restores the map's points from a buffer. Learning continues from them.
+*
+*	@param data The buffer of getCalibrationSize() bytes.
+*/
+void SRL::SpeedMap::loadCalibration(const byte* data)
+{
+	SRL_ATOMIC_BEGIN();
+	memcpy(speeds, data, sizeof(speeds));
+	SRL_ATOMIC_END();
+
+	restart();
+}
+
+/**
+*	Interpolates the speed between the points around a duty cycle.
+*
+*	@param duty The duty cycle, scaled by 2^SPEED_MAP_DUTY_SHIFT.
+*/
+long SRL::SpeedMap::interpolate(unsigned int duty)
+{
+	const unsigned int step = SPEED_MAP_POINT_DUTY << SPEED_MAP_DUTY_SHIFT;
+	uint8_t i = duty / step;
+
+	if (i >= SPEED_MAP_POINTS - 1)
+	{
+		return speeds[SPEED_MAP_POINTS - 1];
+	}
+
+	long fraction = duty % step;
+
+	return speeds[i] + (speeds[i + 1] - speeds[i]) * fraction / step;
+}
+
+/**
+*	Moves the points around a duty cycle towards a measured speed, each by its
+*	share of the interpolation. The point at duty cycle 0 stays at 0. The
+*	neighbouring points are then moved as far as needed to keep the speeds
+*	from decreasing.
+*
+*	@param duty The duty cycle, scaled by 2^SPEED_MAP_DUTY_SHIFT.
+*	@param speed The measured speed.
+*/
+void SRL::SpeedMap::update(unsigned int duty, long speed)
+{
+	const unsigned int step = SPEED_MAP_POINT_DUTY << SPEED_MAP_DUTY_SHIFT;
+	uint8_t i = duty / step;
+	long fraction = duty % step;
+
+	if (i >= SPEED_MAP_POINTS - 1)
+	{
+		i = SPEED_MAP_POINTS - 2;
+		fraction = step;
+	}
+
+	long error = speed - interpolate(duty);
+
+	if (i > 0)
+	{
+		speeds[i] += error * (long) (step - fraction) / step / (1 << SPEED_MAP_LEARN_SHIFT);
+	}
+	speeds[i + 1] += error * fraction / step / (1 << SPEED_MAP_LEARN_SHIFT);
+
+	if (speeds[i + 1] < 0)
+	{
+		speeds[i + 1] = 0;
+	}
+
+	for (uint8_t j = i; j > 0; j--)
+	{
+		if (speeds[j] < 0)
+		{
+			speeds[j] = 0;
+		}
+		if (speeds[j] > speeds[j + 1])
+		{
+			speeds[j] = speeds[j + 1];
+		}
+	}
+
+	for (uint8_t j = i + 1; j < SPEED_MAP_POINTS; j++)
+	{
+		if (speeds[j] < speeds[j - 1])
+		{
+			speeds[j] = speeds[j - 1];
+		}
+	}
+}
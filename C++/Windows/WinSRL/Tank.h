@@ -27,6 +27,8 @@
 #include "SRL.h"
 #include "Motor.h"
 
+#define TANK_DEFAULT_TRACK_WIDTH 15.0 // cm
+
 namespace SRL
 {
   /**
@@ -49,6 +51,8 @@ namespace SRL
       void forwards(void);
       void backwards(void);
       void setUnifiedSpeed(float speed);
+      void setWheelSpeeds(float left, float right);
+      void arc(float speed, double curvature);
 
       /* Enums */
       enum States
@@ -63,10 +67,13 @@ namespace SRL
       unsigned int getDirection(void);
       SRL::Motor* getLeftMotor(void);
       SRL::Motor* getRightMotor(void);
+      void setTrackWidth(double trackWidth);
+      double getTrackWidth(void);
 
     protected:
       SRL::Motor* leftMotor;
       SRL::Motor* rightMotor;
+      double trackWidth;
 
     private:
       unsigned int direction;
@@ -0,0 +1,123 @@
+/*
+* MIT License
+*
+* Copyright (c) 2018 Robert Hutter
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+#ifndef _TELEMETRY_H
+#define _TELEMETRY_H
+
+#include "SRL.h"
+#include "SCOM.h"
+#include "Slave.h"
+#include "Rover.h"
+#include "AccelGyro.h"
+#include "Encoder.h"
+#include "Sonar.h"
+
+#define TELEMETRY_MAX_SONARS 4
+#define TELEMETRY_HEADER 5 // bytes, channel and timestamp
+#define TELEMETRY_MAX_RECORD (TELEMETRY_HEADER + 4 * TELEMETRY_MAX_SONARS)
+#define TELEMETRY_MAX_ENCODED (TELEMETRY_MAX_RECORD + SCOM_FRAME_OVERHEAD + 2)
+#define TELEMETRY_QUEUE 4 // records waiting for room in the serial transmit buffer
+#define TELEMETRY_TX_RESERVE 16 // bytes of the serial transmit buffer left to the SCOM slave's answers
+
+namespace SRL
+{
+	/**
+	*	Class Telemetry. Streams the rover's pose, the AccelGyro's angles, the
+	*	encoder counts and the sonar ranges to the host as SCOM2000 TELEMETRY
+	*	frames, which need no ACK. A record holds the channel, the micros()
+	*	timestamp of its values and the values, big endian: floats for the
+	*	pose (x, y in cm, direction in deg), the angles (deg) and the ranges
+	*	(cm), longs for the counts. Every channel is published every n-th
+	*	update(). Records never wait for the serial port: while its transmit
+	*	buffer is full they are queued, and the oldest queued record is
+	*	dropped for a new one. With a Slave set, records are only sent while
+	*	it has a SCOM2000 link open.
+	*/
+	class Telemetry
+	{
+		public:
+			Telemetry(void);
+
+			void update(void);
+
+			void setDecimation(uint8_t channel, uint8_t decimation);
+			uint8_t getDecimation(uint8_t channel);
+
+			/* Getters & setters */
+			void setSlave(SRL::Slave* slave);
+			void setRover(SRL::Rover* rover);
+			void setAccelGyro(SRL::AccelGyro* accelGyro);
+			void setLeftEncoder(SRL::Encoder* leftEncoder);
+			void setRightEncoder(SRL::Encoder* rightEncoder);
+			uint8_t setSonar(uint8_t index, SRL::Sonar* sonar);
+
+			SRL::Slave* getSlave(void);
+			SRL::Rover* getRover(void);
+			SRL::AccelGyro* getAccelGyro(void);
+			SRL::Encoder* getLeftEncoder(void);
+			SRL::Encoder* getRightEncoder(void);
+			SRL::Sonar* getSonar(uint8_t index);
+
+			unsigned long getSent(void);
+			unsigned long getDropped(void);
+
+			/* Enums */
+			enum Channels
+			{
+				CHANNEL_POSE,
+				CHANNEL_ANGLES,
+				CHANNEL_ENCODERS,
+				CHANNEL_SONAR,
+				CHANNEL_COUNT
+			};
+
+		private:
+			/* Source related fields */
+			SRL::Slave* slave = NULL;
+			SRL::Rover* rover = NULL;
+			SRL::AccelGyro* accelGyro = NULL;
+			SRL::Encoder* leftEncoder = NULL;
+			SRL::Encoder* rightEncoder = NULL;
+			SRL::Sonar* sonars[TELEMETRY_MAX_SONARS];
+
+			/* Decimation related fields */
+			uint8_t decimation[CHANNEL_COUNT];
+			uint8_t countdown[CHANNEL_COUNT];
+
+			/* Transmit queue related fields */
+			byte queue[TELEMETRY_QUEUE][TELEMETRY_MAX_ENCODED];
+			uint8_t queueLength[TELEMETRY_QUEUE];
+			uint8_t queueHead, queueCount;
+			uint8_t sequence;
+			unsigned long sent, dropped;
+
+			void sample(uint8_t channel);
+			void publish(byte* record, uint8_t len);
+			void transmit(void);
+
+			static void putLong(byte* data, uint32_t value);
+			static void putFloat(byte* data, float value);
+	};
+}
+
+#endif
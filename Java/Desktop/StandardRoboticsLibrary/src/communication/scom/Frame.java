@@ -0,0 +1,190 @@
+/*
+ * Copyright (C) 2019 Robert Hutter
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package communication.scom;
+
+import java.io.ByteArrayOutputStream;
+import java.util.Arrays;
+
+/**
+ *  Frame.java - SCOM2000 frame. A frame holds a type, a sequence number, a
+ *  payload and the CRC16 of them, COBS encoded and ended by a 0 byte.
+ * 
+ * @see SCOM2000
+ * @since 2019.11.02
+ * @author deaxuser - Robert Hutter
+ */
+public final class Frame {
+    public final static int HELLO = 1;
+    public final static int COMMAND = 2;
+    public final static int CLOSE = 4;
+    public final static int ACK = 6;
+    public final static int NAK = 21;
+    public final static int TELEMETRY = 32;
+    
+    public final static byte DELIMITER = 0;
+    public final static int MAX_PAYLOAD = 64;
+    public final static int OVERHEAD = 4;
+    public final static int MAX_ENCODED = MAX_PAYLOAD + OVERHEAD + 1;
+    
+    private final static int CRC16_INIT = 0xFFFF;
+    private final static int CRC16_POLYNOMIAL = 0x1021;
+    
+    private final int type;
+    private final int sequence;
+    private final byte[] payload;
+    
+    /**
+     *  Constructor for a Frame.
+     * 
+     * @param type      Frame type.
+     * @param sequence  Sequence number, 0 to 255.
+     * @param payload   Payload of at most MAX_PAYLOAD bytes.
+     */
+    public Frame(int type, int sequence, byte[] payload)
+    {
+        if (payload.length > MAX_PAYLOAD)
+        {
+            throw new IllegalArgumentException("Payload longer than " + MAX_PAYLOAD + " bytes.");
+        }
+        
+        this.type = type;
+        this.sequence = sequence & 0xFF;
+        this.payload = payload;
+    }
+    
+    public int getType()
+    {
+        return type;
+    }
+    
+    public int getSequence()
+    {
+        return sequence;
+    }
+    
+    public byte[] getPayload()
+    {
+        return payload;
+    }
+    
+    /**
+     *  Encodes the frame to send it, including the ending 0 byte.
+     * 
+     * @return The encoded frame.
+     */
+    public byte[] encode()
+    {
+        byte[] frame = new byte[payload.length + OVERHEAD];
+        frame[0] = (byte) type;
+        frame[1] = (byte) sequence;
+        System.arraycopy(payload, 0, frame, 2, payload.length);
+        
+        int crc = crc16(frame, 0, payload.length + 2);
+        frame[frame.length - 2] = (byte) (crc >> 8);
+        frame[frame.length - 1] = (byte) crc;
+        
+        // COBS
+        ByteArrayOutputStream out = new ByteArrayOutputStream(frame.length + 2);
+        int start = 0;
+        for (int i = 0; i <= frame.length; i++)
+        {
+            if (i == frame.length || frame[i] == 0)
+            {
+                out.write(i - start + 1);
+                out.write(frame, start, i - start);
+                start = i + 1;
+            }
+        }
+        out.write(DELIMITER);
+        
+        return out.toByteArray();
+    }
+    
+    /**
+     *  Decodes a received frame.
+     * 
+     * @param data      The encoded frame without the ending 0 byte.
+     * @param length    Number of encoded bytes.
+     * @return The frame, null if it is corrupted.
+     */
+    public static Frame decode(byte[] data, int length)
+    {
+        byte[] frame = new byte[length];
+        int in = 0;
+        int out = 0;
+        
+        while (in < length)
+        {
+            int code = data[in++] & 0xFF;
+            
+            if (code == 0 || in + code - 1 > length)
+            {
+                return null;
+            }
+            
+            for (int i = 1; i < code; i++)
+            {
+                frame[out++] = data[in++];
+            }
+            
+            if (code < 0xFF && in < length)
+            {
+                frame[out++] = 0;
+            }
+        }
+        
+        if (out < OVERHEAD)
+        {
+            return null;
+        }
+        
+        int crc = ((frame[out - 2] & 0xFF) << 8) | (frame[out - 1] & 0xFF);
+        if (crc16(frame, 0, out - 2) != crc)
+        {
+            return null;
+        }
+        
+        return new Frame(frame[0] & 0xFF, frame[1] & 0xFF, Arrays.copyOfRange(frame, 2, out - 2));
+    }
+    
+    /**
+     *  Calculates the CRC16-CCITT of bytes, like the slave's CRC.h.
+     * 
+     * @param data      Bytes to calculate the CRC of.
+     * @param offset    Index of the first byte.
+     * @param length    Number of bytes.
+     * @return The CRC.
+     */
+    static int crc16(byte[] data, int offset, int length)
+    {
+        int crc = CRC16_INIT;
+        
+        for (int i = offset; i < offset + length; i++)
+        {
+            crc ^= (data[i] & 0xFF) << 8;
+            
+            for (int bit = 0; bit < 8; bit++)
+            {
+                crc = (crc & 0x8000) != 0 ? (crc << 1) ^ CRC16_POLYNOMIAL : crc << 1;
+            }
+            
+            crc &= 0xFFFF;
+        }
+        
+        return crc;
+    }
+}
@@ -28,9 +28,11 @@ import java.util.logging.Level;
 import java.util.logging.Logger;
 
 /**
- *  Master.java - SCOM Communication master.
+ *  Master.java - SCOM Communication master. Speaks SCOM1204 after open(),
+ *  and SCOM2000 frames after openFramed().
  * 
  * @see SCOM1204
+ * @see SCOM2000
  * @since 2019.10.26
  * @author deaxuser - Robert Hutter
  */
@@ -49,6 +51,28 @@ public /*final*/ class Master implements SerialPortDataListener
     
     private final Charset charset;
     
+    /* SCOM2000 related fields */
+    private final Object frameLock = new Object();
+    private final byte[] rxFrame = new byte[Frame.MAX_ENCODED];
+    private int rxLength;
+    private boolean rxOverflow;
+    private volatile boolean framed;
+    private volatile int protocolVersion;
+    private volatile int slaveVersion;
+    private volatile int slaveWindow;
+    private int sequence;
+    
+    /* Sliding window related fields, indexed by sequence number */
+    private final byte[][] unacked = new byte[256][];
+    private final long[] sentAt = new long[256];
+    private final int[] attempts = new int[256];
+    private final boolean[] selectivelyAcked = new boolean[256];
+    private int window;
+    private int sendBase;
+    private int helloTimeout = HELLO_TIMEOUT;
+    
+    private volatile TelemetryListener telemetryListener;
+    
     private final static int COMMUNICATION_ENDED = -2;
     private final static int NONE = -1;
     private final static int WAITING_FOR_SLAVE_SIGNAL = 1;
@@ -65,6 +89,11 @@ public /*final*/ class Master implements SerialPortDataListener
     private final static short ACK = 5;
     private final static short ETB = 23;
     
+    private final static short VERSION_2 = 2000;
+    private final static int FRAME_TIMEOUT = 100; // ms, frames not ACKed in time are sent again
+    private final static int HELLO_TIMEOUT = 2500; // ms, longer than a board's reset and bootloader delay
+    private final static int WINDOW = 8; // frames sent ahead of the ACKs, the slave may allow fewer
+    
     /**
      *  Constructor for SCOM Master
      * 
@@ -98,7 +127,8 @@ public /*final*/ class Master implements SerialPortDataListener
     }
     
     /**
-     *  Sends a coammnd over Serial,
+     *  Sends a coammnd over Serial, and waits until the slave received it
+     *  and every command queued before.
      * 
      * @param command
      * @throws exceptions.ConnectionTimeoutException
@@ -106,6 +136,13 @@ public /*final*/ class Master implements SerialPortDataListener
      */
     public void sendCommand(Command command) throws ConnectionTimeoutException
     {
+        if (framed)
+        {
+            queueFrame(Frame.COMMAND, command.toString().getBytes(charset));
+            flush();
+            return;
+        }
+        
         sendSignal(STX);
         while(status != OK_CONTINUE) {watchTimeout();}
         
@@ -122,14 +159,52 @@ public /*final*/ class Master implements SerialPortDataListener
     }
     
     /**
-     *  Opens serial communication.
+     *  Sends a command without waiting for its ACK, so commands stream while
+     *  the window has room. Waits only while the window is full. SCOM1204
+     *  slaves get the command with sendCommand().
      * 
+     * @param command
      * @throws exceptions.ConnectionTimeoutException
-     * @see SCOM Protocol
+     * @see SCOM2000
+     */
+    public void queueCommand(Command command) throws ConnectionTimeoutException
+    {
+        if (!framed)
+        {
+            sendCommand(command);
+            return;
+        }
+        
+        queueFrame(Frame.COMMAND, command.toString().getBytes(charset));
+    }
+    
+    /**
+     *  Waits until the slave ACKed every queued command.
+     * 
+     * @throws exceptions.ConnectionTimeoutException
+     * @see SCOM2000
+     */
+    public void flush() throws ConnectionTimeoutException
+    {
+        synchronized (frameLock)
+        {
+            while (sendBase != sequence)
+            {
+                waitForAcks();
+            }
+        }
+    }
+    
+    /**
+     *  Opens serial communication with SCOM1204, which every slave speaks.
+     * 
+     * @throws exceptions.ConnectionTimeoutException
+     * @see SCOM1204
      * @throws exceptions.IncompatibleProtocolVersionException
      */
     public void open() throws IncompatibleProtocolVersionException, ConnectionTimeoutException
     {
+        framed = false;
         port.openPort();
         port.addDataListener(this);
         
@@ -152,16 +227,140 @@ public /*final*/ class Master implements SerialPortDataListener
         {
             sendSignal(ETB);
             while(status != OK_CONTINUE) {watchTimeout();}
+            protocolVersion = VERSION;
         }
     }
     
+    /**
+     *  Opens serial communication with SCOM2000: sends the HELLO until the
+     *  slave answers or the HELLO timeout passes. Only for slaves known to
+     *  speak SCOM2000, older slaves read the HELLO as SCOM1204 signals and
+     *  lose their handshake, so reset such a slave before calling open().
+     * 
+     * @return True if the slave answered, false if it did not.
+     * @throws exceptions.IncompatibleProtocolVersionException
+     * @see SCOM2000
+     */
+    public boolean openFramed() throws IncompatibleProtocolVersionException
+    {
+        port.openPort();
+        port.addDataListener(this);
+        
+        framed = true;
+        slaveVersion = 0;
+        slaveWindow = 1;
+        rxLength = 0;
+        rxOverflow = false;
+        
+        byte[] hello = new Frame(Frame.HELLO, 0, ByteBuffer.allocate(3).putShort(VERSION_2).put((byte) WINDOW).array()).encode();
+        
+        synchronized (frameLock)
+        {
+            long end = System.currentTimeMillis() + helloTimeout;
+            
+            while (slaveVersion == 0 && System.currentTimeMillis() < end)
+            {
+                port.writeBytes(hello, hello.length);
+                
+                long deadline = Math.min(System.currentTimeMillis() + FRAME_TIMEOUT, end);
+                while (slaveVersion == 0 && System.currentTimeMillis() < deadline)
+                {
+                    waitForFrame(deadline);
+                }
+            }
+        }
+        
+        if (slaveVersion == 0)
+        {
+            framed = false;
+            return false;
+        }
+        
+        if (slaveVersion < VERSION_2)
+        {
+            close();
+            throw new exceptions.IncompatibleProtocolVersionException();
+        }
+        
+        protocolVersion = slaveVersion;
+        window = Math.min(slaveWindow, WINDOW);
+        sequence = 0;
+        sendBase = 0;
+        Arrays.fill(unacked, null);
+        return true;
+    }
+    
+    /**
+     *  Sets how long openFramed() keeps sending the SCOM2000 HELLO. Boards that
+     *  reset when the port is opened need the HELLO window to outlast their
+     *  bootloader.
+     * 
+     * @param timeout   HELLO window in ms.
+     */
+    public void setHelloTimeout(int timeout)
+    {
+        helloTimeout = timeout;
+    }
+    
+    /**
+     *  Returns how long openFramed() keeps sending the SCOM2000 HELLO.
+     * 
+     * @return HELLO window in ms.
+     */
+    public int getHelloTimeout()
+    {
+        return helloTimeout;
+    }
+    
+    /**
+     *  Returns the number of commands sent ahead of the ACKs, 1 for stop and
+     *  wait.
+     * 
+     * @return The window's size.
+     */
+    public int getWindow()
+    {
+        return framed ? window : 1;
+    }
+    
+    /**
+     *  Returns the protocol version agreed with the slave, 0 if there is none.
+     * 
+     * @return The protocol version.
+     */
+    public int getVersion()
+    {
+        return protocolVersion;
+    }
+    
     /**
      *  Closes serial communication.
      */
     public void close()
     {
         status = COMMUNICATION_ENDED;
-        writeInt16(EOT);
+        
+        if (framed)
+        {
+            try
+            {
+                flush();
+            }
+            catch (ConnectionTimeoutException ex)
+            {
+                Logger.getLogger(Master.class.getName()).log(Level.SEVERE, null, ex);
+            }
+            
+            byte[] b = new Frame(Frame.CLOSE, sequence, new byte[0]).encode();
+            port.writeBytes(b, b.length);
+            framed = false;
+        }
+        else
+        {
+            writeInt16(EOT);
+        }
+        
+        protocolVersion = 0;
         port.closePort();
     }
     
@@ -225,6 +424,269 @@ public /*final*/ class Master implements SerialPortDataListener
        System.out.println("Sent signal: ["+i+"]");
     }
 
+    /**
+     * Sends a frame to the Slave once the window has room. Its ACK is not
+     * waited for, frames not ACKed in time are sent again by waitForAcks().
+     * 
+     * @see SCOM2000
+     * @param type      Frame type.
+     * @param payload   Frame payload.
+     * @throws exceptions.ConnectionTimeoutException
+     */
+    private void queueFrame(int type, byte[] payload) throws ConnectionTimeoutException
+    {
+        synchronized (frameLock)
+        {
+            while (((sequence - sendBase) & 0xFF) >= window)
+            {
+                waitForAcks();
+            }
+            
+            int seq = sequence;
+            sequence = (sequence + 1) & 0xFF;
+            
+            unacked[seq] = new Frame(type, seq, payload).encode();
+            attempts[seq] = 0;
+            selectivelyAcked[seq] = false;
+            transmit(seq);
+        }
+    }
+    
+    /**
+     * Sends a frame of the window. The caller holds frameLock.
+     * 
+     * @param seq Sequence number of the frame.
+     */
+    private void transmit(int seq)
+    {
+        port.writeBytes(unacked[seq], unacked[seq].length);
+        sentAt[seq] = System.currentTimeMillis();
+        attempts[seq]++;
+    }
+    
+    /**
+     * Sends the frames whose ACK is overdue again, except the ones the slave
+     * selectively ACKed, then waits for the next frame from the Slave. The
+     * caller holds frameLock.
+     * 
+     * @throws exceptions.ConnectionTimeoutException
+     */
+    private void waitForAcks() throws ConnectionTimeoutException
+    {
+        long now = System.currentTimeMillis();
+        long deadline = now + FRAME_TIMEOUT;
+        
+        for (int seq = sendBase; seq != sequence; seq = (seq + 1) & 0xFF)
+        {
+            if (selectivelyAcked[seq])
+            {
+                continue;
+            }
+            
+            if (now - sentAt[seq] >= FRAME_TIMEOUT)
+            {
+                if (attempts[seq] >= MAX_ATTEMPTS)
+                {
+                    throw new ConnectionTimeoutException();
+                }
+                
+                transmit(seq);
+            }
+            
+            deadline = Math.min(deadline, sentAt[seq] + FRAME_TIMEOUT);
+        }
+        
+        waitForFrame(deadline);
+    }
+    
+    /**
+     * Handles an ACK. Every frame before the ACKed sequence number left the
+     * window. Bit i of the bitmap tells the slave holds frame seq + 2 + i,
+     * so the frames missing before it are sent again right away, once.
+     * The caller holds frameLock.
+     * 
+     * @param seq       The last frame the slave received in order.
+     * @param bitmap    The frames the slave received after the first missing one.
+     */
+    private void acknowledge(int seq, int bitmap)
+    {
+        int outstanding = (sequence - sendBase) & 0xFF;
+        int acked = ((seq - sendBase) & 0xFF) + 1;
+        
+        // ACKs of frames already out of the window are old news
+        if (acked <= outstanding)
+        {
+            for (int i = 0; i < acked; i++)
+            {
+                unacked[sendBase] = null;
+                sendBase = (sendBase + 1) & 0xFF;
+            }
+        }
+        else if (seq != ((sendBase - 1) & 0xFF))
+        {
+            return;
+        }
+        
+        int last = NONE;
+        for (int i = 0; i < 7; i++)
+        {
+            int s = (seq + 2 + i) & 0xFF;
+            
+            if ((bitmap & (1 << i)) != 0 && ((s - sendBase) & 0xFF) < ((sequence - sendBase) & 0xFF))
+            {
+                selectivelyAcked[s] = true;
+                last = s;
+            }
+        }
+        
+        if (last != NONE)
+        {
+            for (int s = sendBase; s != last; s = (s + 1) & 0xFF)
+            {
+                if (!selectivelyAcked[s] && attempts[s] == 1)
+                {
+                    transmit(s);
+                }
+            }
+        }
+    }
+    
+    /**
+     * Waits for the next frame from the Slave. The caller holds frameLock.
+     * 
+     * @param deadline Time to stop waiting at, in milliseconds.
+     */
+    private void waitForFrame(long deadline)
+    {
+        long remaining = deadline - System.currentTimeMillis();
+        if (remaining <= 0)
+        {
+            return;
+        }
+        
+        try
+        {
+            frameLock.wait(remaining);
+        }
+        catch (InterruptedException ex)
+        {
+            Logger.getLogger(Master.class.getName()).log(Level.SEVERE, null, ex);
+        }
+    }
+    
+    /**
+     * Collects received bytes into frames and handles the complete ones.
+     * 
+     * @param data Received bytes.
+     */
+    private void receiveFrames(byte[] data)
+    {
+        for (byte b : data)
+        {
+            if (b == Frame.DELIMITER)
+            {
+                if (!rxOverflow && rxLength > 0)
+                {
+                    handleFrame(Frame.decode(rxFrame, rxLength));
+                }
+                
+                rxLength = 0;
+                rxOverflow = false;
+            }
+            else if (rxLength < rxFrame.length)
+            {
+                rxFrame[rxLength++] = b;
+            }
+            else
+            {
+                rxOverflow = true;
+            }
+        }
+    }
+    
+    /**
+     * Handles a frame from the Slave. Corrupted frames are dropped, the
+     * frame waiting for them is sent again on timeout.
+     * 
+     * @param frame Received frame, null if corrupted.
+     */
+    private void handleFrame(Frame frame)
+    {
+        if (frame == null)
+        {
+            return;
+        }
+        
+        if (frame.getType() == Frame.TELEMETRY)
+        {
+            handleTelemetry(frame.getPayload());
+            return;
+        }
+        
+        synchronized (frameLock)
+        {
+            byte[] payload = frame.getPayload();
+            
+            switch (frame.getType())
+            {
+                case Frame.HELLO:
+                    if (payload.length >= 2)
+                    {
+                        // Slaves without a window stop and wait
+                        slaveWindow = payload.length >= 3 ? Math.max(payload[2] & 0xFF, 1) : 1;
+                        slaveVersion = ((payload[0] & 0xFF) << 8) | (payload[1] & 0xFF);
+                    }
+                    break;
+                case Frame.ACK:
+                    acknowledge(frame.getSequence(), payload.length > 0 ? payload[0] & 0xFF : 0);
+                    break;
+                case Frame.NAK:
+                    // The slave could not tell which frame it lost, try the oldest one
+                    if (sendBase != sequence && attempts[sendBase] == 1)
+                    {
+                        transmit(sendBase);
+                    }
+                    break;
+                default:
+                    break;
+            }
+            
+            frameLock.notifyAll();
+        }
+    }
+    
+    /**
+     * Passes a telemetry record to the TelemetryListener. Records are not
+     * ACKed, lost ones show as gaps in their frames' sequence numbers.
+     * 
+     * @param payload The record: channel, timestamp and values.
+     */
+    private void handleTelemetry(byte[] payload)
+    {
+        TelemetryListener listener = telemetryListener;
+        
+        if (listener == null || payload.length < TelemetryListener.HEADER)
+        {
+            return;
+        }
+        
+        ByteBuffer record = ByteBuffer.wrap(payload);
+        int channel = record.get() & 0xFF;
+        long timestamp = record.getInt() & 0xFFFFFFFFL;
+        
+        listener.telemetryReceived(channel, timestamp, record.slice());
+    }
+    
+    /**
+     * Sets the listener of the telemetry records the Slave streams.
+     * 
+     * @param listener The listener, null to ignore telemetry.
+     */
+    public void setTelemetryListener(TelemetryListener listener)
+    {
+        telemetryListener = listener;
+    }
+
     @Override
     public int getListeningEvents() {
         return SerialPort.LISTENING_EVENT_DATA_RECEIVED;
@@ -232,6 +694,12 @@ public /*final*/ class Master implements SerialPortDataListener
 
     @Override
     public void serialEvent(SerialPortEvent event) {
+        if (framed)
+        {
+            receiveFrames(event.getReceivedData());
+            return;
+        }
+        
         System.out.println("Received: "+Arrays.toString(event.getReceivedData()));
         
         if (event.getReceivedData().length > 1)
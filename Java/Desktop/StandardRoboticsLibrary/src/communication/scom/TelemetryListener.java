@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2019 Robert Hutter
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package communication.scom;
+
+import java.nio.ByteBuffer;
+
+/**
+ *  TelemetryListener.java - Receives the telemetry records a Slave streams
+ *  in SCOM2000 TELEMETRY frames.
+ * 
+ * @see Master
+ * @since 2019.11.16
+ * @author deaxuser - Robert Hutter
+ */
+public interface TelemetryListener {
+    public final static int POSE = 0;
+    public final static int ANGLES = 1;
+    public final static int ENCODERS = 2;
+    public final static int SONAR = 3;
+    
+    public final static int HEADER = 5;
+    
+    /**
+     * Called from the serial port's thread for every telemetry record.
+     * 
+     * @param channel   POSE (x, y, direction floats), ANGLES (x, y, z
+     *                  floats), ENCODERS (left, right ints) or SONAR (a
+     *                  float range per sonar).
+     * @param timestamp The Slave's micros() the values were captured at.
+     * @param values    The values, big endian.
+     */
+    void telemetryReceived(int channel, long timestamp, ByteBuffer values);
+}
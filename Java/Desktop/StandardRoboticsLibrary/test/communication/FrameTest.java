@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2019 Robert Hutter
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package communication;
+
+import communication.scom.Frame;
+import java.util.Arrays;
+
+/**
+ *  Encodes SCOM2000 frames and decodes them again.
+ * 
+ * @author deaxuser
+ */
+public class FrameTest {
+    
+    private static int failures = 0;
+
+    /**
+     * @param args the command line arguments
+     */
+    public static void main(String[] args) {
+        byte[] zeros = new byte[Frame.MAX_PAYLOAD];
+        byte[] ones = new byte[Frame.MAX_PAYLOAD];
+        Arrays.fill(ones, (byte) 0xFF);
+        
+        roundTrip("empty", new Frame(Frame.HELLO, 0, new byte[0]));
+        roundTrip("text", new Frame(Frame.COMMAND, 7, "forward(10,10)".getBytes()));
+        roundTrip("zeros", new Frame(Frame.COMMAND, 255, zeros));
+        roundTrip("ones", new Frame(Frame.TELEMETRY, 128, ones));
+        roundTrip("mixed", new Frame(Frame.ACK, 3, new byte[]{0, 1, 0, 0, 2, (byte) 0xFF, 0}));
+        
+        byte[] encoded = new Frame(Frame.COMMAND, 1, "stop()".getBytes()).encode();
+        
+        encoded[3] ^= 0x10;
+        check("corrupted byte is rejected", Frame.decode(encoded, encoded.length - 1) == null);
+        encoded[3] ^= 0x10;
+        
+        check("truncated frame is rejected", Frame.decode(encoded, encoded.length - 3) == null);
+        check("intact frame is accepted", Frame.decode(encoded, encoded.length - 1) != null);
+        
+        System.out.println(failures == 0 ? "All frame tests passed." : failures + " frame tests failed.");
+        
+        if (failures != 0)
+        {
+            System.exit(1);
+        }
+    }
+    
+    private static void roundTrip(String name, Frame frame)
+    {
+        byte[] encoded = frame.encode();
+        
+        boolean delimited = encoded[encoded.length - 1] == Frame.DELIMITER;
+        for (int i = 0; i < encoded.length - 1; i++)
+        {
+            delimited &= encoded[i] != Frame.DELIMITER;
+        }
+        check(name + ": only the last byte is 0", delimited);
+        
+        Frame decoded = Frame.decode(encoded, encoded.length - 1);
+        check(name + ": decodes", decoded != null);
+        
+        if (decoded != null)
+        {
+            check(name + ": type", decoded.getType() == frame.getType());
+            check(name + ": sequence", decoded.getSequence() == frame.getSequence());
+            check(name + ": payload", Arrays.equals(decoded.getPayload(), frame.getPayload()));
+        }
+    }
+    
+    private static void check(String name, boolean passed)
+    {
+        if (!passed)
+        {
+            failures++;
+            System.out.println("FAILED: " + name);
+        }
+    }
+    
+}